@@ -30,6 +30,7 @@
 #include <sstream>
 #include <cassert>
 #include "allocator.hpp"
+#include "checkpoint.hpp"
 
 /////////////////////////////////////////////////////////////////////////
 //Allocator types
@@ -41,6 +42,7 @@
 #include "selalloc.hpp"
 #include "separable_input_first.hpp"
 #include "separable_output_first.hpp"
+#include "hierarchical.hpp"
 //
 /////////////////////////////////////////////////////////////////////////
 
@@ -56,6 +58,15 @@ Module( parent, name ), _inputs( inputs ), _outputs( outputs ), _dirty( false )
   _outmatch.resize(_outputs, -1);
 }
 
+void Allocator::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "allocator inputs", _inputs );
+  cp.Check( "allocator outputs", _outputs );
+  cp.Value( _dirty );
+  cp.Value( _inmatch );
+  cp.Value( _outmatch );
+}
+
 void Allocator::Clear( )
 {
   if(_dirty) {
@@ -125,6 +136,12 @@ DenseAllocator::DenseAllocator( Module *parent, const string& name,
   }
 }
 
+void DenseAllocator::_Serialize( Checkpoint & cp )
+{
+  Allocator::_Serialize( cp );
+  cp.Value( _request );
+}
+
 void DenseAllocator::Clear( )
 {
   for ( int i = 0; i < _inputs; ++i ) {
@@ -263,6 +280,15 @@ SparseAllocator::SparseAllocator( Module *parent, const string& name,
   _out_req.resize(_outputs);
 }
 
+void SparseAllocator::_Serialize( Checkpoint & cp )
+{
+  Allocator::_Serialize( cp );
+  cp.Value( _in_occ );
+  cp.Value( _out_occ );
+  cp.Value( _in_req );
+  cp.Value( _out_req );
+}
+
 
 void SparseAllocator::Clear( )
 {
@@ -419,6 +445,206 @@ void SparseAllocator::PrintRequests( ostream * os ) const
   *os << "]." << endl;
 }
 
+//==================================================
+// BitsetAllocator
+//==================================================
+
+BitsetAllocator::BitsetAllocator( Module *parent, const string& name,
+				  int inputs, int outputs ) :
+  Allocator( parent, name, inputs, outputs ),
+  _in_words( ( outputs + 63 ) / 64 ), _out_words( ( inputs + 63 ) / 64 )
+{
+  _in_req.resize(_inputs * _in_words, 0);
+  _out_req.resize(_outputs * _out_words, 0);
+  _in_occ.resize(_out_words, 0);
+  _out_occ.resize(_in_words, 0);
+  _in_info.resize(_inputs);
+  _in_slot.resize(_inputs);
+}
+
+void BitsetAllocator::_Serialize( Checkpoint & cp )
+{
+  Allocator::_Serialize( cp );
+  cp.Value( _in_req );
+  cp.Value( _out_req );
+  cp.Value( _in_occ );
+  cp.Value( _out_occ );
+  cp.Value( _in_info );
+  cp.Value( _in_slot );
+}
+
+const Allocator::sRequest & BitsetAllocator::_Info( int in, int out ) const
+{
+  int const slot = _in_slot[in][out];
+  assert( slot >= 0 );
+  return _in_info[in][slot];
+}
+
+void BitsetAllocator::Clear( )
+{
+  for ( int w = 0; w < _out_words; ++w ) {
+    unsigned long long bits = _in_occ[w];
+    while ( bits ) {
+      int const in = w * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+      for ( int v = 0; v < _in_words; ++v ) {
+	_in_req[in * _in_words + v] = 0;
+      }
+      vector<sRequest> & info = _in_info[in];
+      for ( size_t i = 0; i < info.size( ); ++i ) {
+	_in_slot[in][info[i].port] = -1;
+      }
+      info.clear();
+    }
+    _in_occ[w] = 0;
+  }
+  for ( int w = 0; w < _in_words; ++w ) {
+    unsigned long long bits = _out_occ[w];
+    while ( bits ) {
+      int const out = w * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+      for ( int v = 0; v < _out_words; ++v ) {
+	_out_req[out * _out_words + v] = 0;
+      }
+    }
+    _out_occ[w] = 0;
+  }
+  Allocator::Clear();
+}
+
+int BitsetAllocator::ReadRequest( int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( _in_req[in * _in_words + out / 64] & ( 1ULL << ( out % 64 ) ) ) {
+    return _Info(in, out).label;
+  }
+  return -1;
+}
+
+bool BitsetAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  if ( !( _in_req[in * _in_words + out / 64] & ( 1ULL << ( out % 64 ) ) ) ) {
+    return false;
+  }
+  req = _Info(in, out);
+  return true;
+}
+
+void BitsetAllocator::AddRequest( int in, int out, int label, 
+				  int in_pri, int out_pri )
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert( ReadRequest(in, out) == -1 );
+
+  _in_req[in * _in_words + out / 64] |= 1ULL << ( out % 64 );
+  _out_req[out * _out_words + in / 64] |= 1ULL << ( in % 64 );
+  _in_occ[in / 64] |= 1ULL << ( in % 64 );
+  _out_occ[out / 64] |= 1ULL << ( out % 64 );
+
+  sRequest req;
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+  vector<int> & slot = _in_slot[in];
+  if ( slot.empty( ) ) {
+    slot.resize(_outputs, -1);
+  }
+  slot[out] = _in_info[in].size( );
+  _in_info[in].push_back(req);
+}
+
+void BitsetAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) ); 
+  assert( ReadRequest(in, out) == label );
+
+  _in_req[in * _in_words + out / 64] &= ~( 1ULL << ( out % 64 ) );
+  _out_req[out * _out_words + in / 64] &= ~( 1ULL << ( in % 64 ) );
+
+  // move the last request into the freed slot
+  vector<sRequest> & info = _in_info[in];
+  vector<int> & slot = _in_slot[in];
+  int const i = slot[out];
+  info[i] = info.back( );
+  slot[info[i].port] = i;
+  info.pop_back( );
+  slot[out] = -1;
+
+  // remove from occupied inputs and outputs if now empty
+  if ( NumInputRequests(in) == 0 ) {
+    _in_occ[in / 64] &= ~( 1ULL << ( in % 64 ) );
+  }
+  if ( NumOutputRequests(out) == 0 ) {
+    _out_occ[out / 64] &= ~( 1ULL << ( out % 64 ) );
+  }
+}
+
+bool BitsetAllocator::InputHasRequests( int in ) const
+{
+  return ( _in_occ[in / 64] >> ( in % 64 ) ) & 1;
+}
+
+bool BitsetAllocator::OutputHasRequests( int out ) const
+{
+  return ( _out_occ[out / 64] >> ( out % 64 ) ) & 1;
+}
+
+int BitsetAllocator::NumInputRequests( int in ) const
+{
+  int result = 0;
+  for ( int w = 0; w < _in_words; ++w ) {
+    result += __builtin_popcountll(_in_req[in * _in_words + w]);
+  }
+  return result;
+}
+
+int BitsetAllocator::NumOutputRequests( int out ) const
+{
+  int result = 0;
+  for ( int w = 0; w < _out_words; ++w ) {
+    result += __builtin_popcountll(_out_req[out * _out_words + w]);
+  }
+  return result;
+}
+
+void BitsetAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+  
+  *os << "Input requests = [ ";
+  for ( int input = 0; input < _inputs; ++input ) {
+    if(InputHasRequests(input)) {
+      *os << input << " -> [ ";
+      for ( int output = 0; output < _outputs; ++output ) {
+	if(ReadRequest(input, output) >= 0) {
+	  *os << output << "@" << _Info(input, output).in_pri << " ";
+	}
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "], output requests = [ ";
+  for ( int output = 0; output < _outputs; ++output ) {
+    if(OutputHasRequests(output)) {
+      *os << output << " -> [ ";
+      for ( int input = 0; input < _inputs; ++input ) {
+	if(ReadRequest(input, output) >= 0) {
+	  *os << input << "@" << _Info(input, output).out_pri << " ";
+	}
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
+
 //==================================================
 // Global allocator allocation function
 //==================================================
@@ -469,6 +695,10 @@ Allocator *Allocator::NewAllocator( Module *parent, const string& name,
     string arb_type = param_str.empty() ? (config ? config->GetStr("arb_type") : "round_robin") : param_str;
     a = new SeparableOutputFirstAllocator( parent, name, inputs, outputs,
 					   arb_type );
+  } else if (alloc_name == "hierarchical_input_first") {
+    a = new HierarchicalAllocator( parent, name, inputs, outputs, true );
+  } else if (alloc_name == "hierarchical_output_first") {
+    a = new HierarchicalAllocator( parent, name, inputs, outputs, false );
   }
 
 //==================================================
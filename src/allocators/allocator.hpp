@@ -46,6 +46,8 @@ protected:
   vector<int> _inmatch;
   vector<int> _outmatch;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   struct sRequest {
@@ -96,6 +98,8 @@ class DenseAllocator : public Allocator {
 protected:
   vector<vector<sRequest> > _request;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   DenseAllocator( Module *parent, const string& name,
 		  int inputs, int outputs );
@@ -132,6 +136,8 @@ protected:
   vector<map<int, sRequest> > _in_req;
   vector<map<int, sRequest> > _out_req;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   SparseAllocator( Module *parent, const string& name,
 		   int inputs, int outputs );
@@ -155,4 +161,57 @@ public:
 
 };
 
+//==================================================
+// A bitset allocator stores the request matrix as one
+// bit row per input plus the transposed bit columns,
+// so that clearing it and finding requests only
+// touches the words that are actually occupied. Labels
+// and priorities are kept in a short list of requests
+// per input, so memory stays linear in the port count.
+//==================================================
+
+class BitsetAllocator : public Allocator {
+protected:
+  const int _in_words;
+  const int _out_words;
+
+  vector<unsigned long long> _in_req;
+  vector<unsigned long long> _out_req;
+
+  vector<unsigned long long> _in_occ;
+  vector<unsigned long long> _out_occ;
+
+  vector<vector<sRequest> > _in_info;
+
+  // position of each output's request in _in_info, or -1; only allocated
+  // for inputs that have made a request
+  vector<vector<int> > _in_slot;
+
+  const sRequest & _Info( int in, int out ) const;
+
+  virtual void _Serialize( Checkpoint & cp );
+
+public:
+  BitsetAllocator( Module *parent, const string& name,
+		   int inputs, int outputs );
+
+  void Clear( );
+  
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1, 
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+  
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+
+};
+
 #endif
@@ -0,0 +1,346 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  HierarchicalAllocator: Separable allocator that only stores the 
+//  requests that were actually made
+//
+// ----------------------------------------------------------------------
+
+#include "hierarchical.hpp"
+#include "checkpoint.hpp"
+
+#include "booksim.hpp"
+#include "roundrobin_arb.hpp"
+
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+
+HierarchicalAllocator::HierarchicalAllocator( Module *parent, 
+					      const string& name,
+					      int inputs, int outputs,
+					      bool input_first )
+  : Allocator( parent, name, inputs, outputs ), _input_first( input_first )
+{
+  _in_req.resize(inputs);
+  _out_reqs.resize(outputs, 0);
+  _in_ptr.resize(inputs, 0);
+  _out_ptr.resize(outputs, 0);
+  _out_winner.resize(outputs, -1);
+  _out_winner_pri.resize(outputs);
+  _out_winner_in_pri.resize(outputs);
+  _in_winner.resize(inputs, -1);
+  _in_winner_pri.resize(inputs);
+}
+
+void HierarchicalAllocator::_Serialize( Checkpoint & cp )
+{
+  Allocator::_Serialize( cp );
+  cp.Value( _in_req );
+  cp.Value( _out_reqs );
+  cp.Value( _in_occ );
+  cp.Value( _out_occ );
+  cp.Value( _in_ptr );
+  cp.Value( _out_ptr );
+  cp.Value( _out_winner );
+  cp.Value( _out_winner_pri );
+  cp.Value( _out_winner_in_pri );
+  cp.Value( _in_winner );
+  cp.Value( _in_winner_pri );
+  cp.Value( _out_touched );
+  cp.Value( _in_touched );
+}
+
+void HierarchicalAllocator::Clear( )
+{
+  for ( size_t i = 0; i < _in_occ.size( ); ++i ) {
+    _in_req[_in_occ[i]].clear( );
+  }
+  for ( size_t o = 0; o < _out_occ.size( ); ++o ) {
+    _out_reqs[_out_occ[o]] = 0;
+  }
+  _in_occ.clear( );
+  _out_occ.clear( );
+  Allocator::Clear( );
+}
+
+int HierarchicalAllocator::ReadRequest( int in, int out ) const
+{
+  sRequest r;
+
+  if ( ! ReadRequest( r, in, out ) ) {
+    r.label = -1;
+  } 
+
+  return r.label;
+}
+
+bool HierarchicalAllocator::ReadRequest( sRequest &req, int in, int out ) const
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) );
+
+  vector<sRequest> const & reqs = _in_req[in];
+  for ( size_t r = 0; r < reqs.size( ); ++r ) {
+    if ( reqs[r].port == out ) {
+      req = reqs[r];
+      return true;
+    }
+  }
+  return false;
+}
+
+void HierarchicalAllocator::AddRequest( int in, int out, int label, 
+					int in_pri, int out_pri )
+{
+  Allocator::AddRequest(in, out, label, in_pri, out_pri);
+  assert( ReadRequest(in, out) == -1 );
+
+  if ( _in_req[in].empty( ) ) {
+    _in_occ.push_back(in);
+  }
+  if ( _out_reqs[out] == 0 ) {
+    _out_occ.push_back(out);
+  }
+  ++_out_reqs[out];
+
+  sRequest req;
+  req.port    = out;
+  req.label   = label;
+  req.in_pri  = in_pri;
+  req.out_pri = out_pri;
+  _in_req[in].push_back(req);
+}
+
+void HierarchicalAllocator::RemoveRequest( int in, int out, int label )
+{
+  assert( ( in >= 0 ) && ( in < _inputs ) );
+  assert( ( out >= 0 ) && ( out < _outputs ) ); 
+  assert( ReadRequest(in, out) == label );
+
+  vector<sRequest> & reqs = _in_req[in];
+  for ( size_t r = 0; r < reqs.size( ); ++r ) {
+    if ( reqs[r].port == out ) {
+      reqs.erase(reqs.begin( ) + r);
+      break;
+    }
+  }
+
+  // remove from occupied inputs and outputs if now empty
+  if ( reqs.empty( ) ) {
+    _in_occ.erase(find(_in_occ.begin( ), _in_occ.end( ), in));
+  }
+  if ( --_out_reqs[out] == 0 ) {
+    _out_occ.erase(find(_out_occ.begin( ), _out_occ.end( ), out));
+  }
+}
+
+bool HierarchicalAllocator::InputHasRequests( int in ) const
+{
+  return !_in_req[in].empty( );
+}
+
+bool HierarchicalAllocator::OutputHasRequests( int out ) const
+{
+  return _out_reqs[out] > 0;
+}
+
+int HierarchicalAllocator::NumInputRequests( int in ) const
+{
+  return _in_req[in].size( );
+}
+
+int HierarchicalAllocator::NumOutputRequests( int out ) const
+{
+  return _out_reqs[out];
+}
+
+void HierarchicalAllocator::Allocate( )
+{
+  if ( _input_first ) {
+    _AllocateInputFirst( );
+  } else {
+    _AllocateOutputFirst( );
+  }
+}
+
+void HierarchicalAllocator::_AllocateInputFirst( )
+{
+  _out_touched.clear( );
+
+  for ( size_t i = 0; i < _in_occ.size( ); ++i ) {
+
+    int const input = _in_occ[i];
+
+    // input arbitration over the outputs this input requested
+
+    vector<sRequest> const & reqs = _in_req[input];
+    assert( !reqs.empty( ) );
+    int best = 0;
+    for ( size_t r = 1; r < reqs.size( ); ++r ) {
+      if ( RoundRobinArbiter::Supersedes( reqs[r].port, reqs[r].in_pri,
+					  reqs[best].port, reqs[best].in_pri,
+					  _in_ptr[input], _outputs ) ) {
+	best = r;
+      }
+    }
+
+    // propagate the grant to the output arbitration
+
+    int const output = reqs[best].port;
+    int const pri = reqs[best].out_pri;
+    if ( _out_winner[output] < 0 ) {
+      _out_touched.push_back(output);
+    } else if ( !RoundRobinArbiter::Supersedes( input, pri, 
+						_out_winner[output],
+						_out_winner_pri[output],
+						_out_ptr[output], _inputs ) ) {
+      continue;
+    }
+    _out_winner[output] = input;
+    _out_winner_pri[output] = pri;
+  }
+
+  for ( size_t o = 0; o < _out_touched.size( ); ++o ) {
+
+    int const output = _out_touched[o];
+    int const input = _out_winner[output];
+    assert( ( _inmatch[input] == -1 ) && ( _outmatch[output] == -1 ) );
+
+    _inmatch[input] = output;
+    _outmatch[output] = input;
+    _in_ptr[input] = ( output + 1 ) % _outputs;
+    _out_ptr[output] = ( input + 1 ) % _inputs;
+    _out_winner[output] = -1;
+  }
+}
+
+void HierarchicalAllocator::_AllocateOutputFirst( )
+{
+  _out_touched.clear( );
+
+  // output arbitration over all inputs requesting each output
+
+  for ( size_t i = 0; i < _in_occ.size( ); ++i ) {
+
+    int const input = _in_occ[i];
+    vector<sRequest> const & reqs = _in_req[input];
+
+    for ( size_t r = 0; r < reqs.size( ); ++r ) {
+      int const output = reqs[r].port;
+      if ( _out_winner[output] < 0 ) {
+	_out_touched.push_back(output);
+      } else if ( !RoundRobinArbiter::Supersedes( input, reqs[r].out_pri,
+						  _out_winner[output],
+						  _out_winner_pri[output],
+						  _out_ptr[output], 
+						  _inputs ) ) {
+	continue;
+      }
+      _out_winner[output] = input;
+      _out_winner_pri[output] = reqs[r].out_pri;
+      _out_winner_in_pri[output] = reqs[r].in_pri;
+    }
+  }
+
+  // propagate the grants to the input arbitration
+
+  _in_touched.clear( );
+
+  for ( size_t o = 0; o < _out_touched.size( ); ++o ) {
+
+    int const output = _out_touched[o];
+    int const input = _out_winner[output];
+    int const pri = _out_winner_in_pri[output];
+    _out_winner[output] = -1;
+
+    if ( _in_winner[input] < 0 ) {
+      _in_touched.push_back(input);
+    } else if ( !RoundRobinArbiter::Supersedes( output, pri, 
+						_in_winner[input],
+						_in_winner_pri[input],
+						_in_ptr[input], _outputs ) ) {
+      continue;
+    }
+    _in_winner[input] = output;
+    _in_winner_pri[input] = pri;
+  }
+
+  for ( size_t i = 0; i < _in_touched.size( ); ++i ) {
+
+    int const input = _in_touched[i];
+    int const output = _in_winner[input];
+    assert( ( _inmatch[input] == -1 ) && ( _outmatch[output] == -1 ) );
+
+    _inmatch[input] = output;
+    _outmatch[output] = input;
+    _in_ptr[input] = ( output + 1 ) % _outputs;
+    _out_ptr[output] = ( input + 1 ) % _inputs;
+    _in_winner[input] = -1;
+  }
+}
+
+void HierarchicalAllocator::PrintRequests( ostream * os ) const
+{
+  if(!os) os = &cout;
+
+  vector<int> inputs(_in_occ);
+  sort(inputs.begin( ), inputs.end( ));
+
+  vector<vector<pair<int, int> > > out_req(_outputs);
+  
+  *os << "Input requests = [ ";
+  for ( size_t i = 0; i < inputs.size( ); ++i ) {
+    int const input = inputs[i];
+    vector<sRequest> const & reqs = _in_req[input];
+    *os << input << " -> [ ";
+    vector<pair<int, int> > in_req;
+    for ( size_t r = 0; r < reqs.size( ); ++r ) {
+      in_req.push_back(make_pair(reqs[r].port, reqs[r].in_pri));
+      out_req[reqs[r].port].push_back(make_pair(input, reqs[r].out_pri));
+    }
+    sort(in_req.begin( ), in_req.end( ));
+    for ( size_t r = 0; r < in_req.size( ); ++r ) {
+      *os << in_req[r].first << "@" << in_req[r].second << " ";
+    }
+    *os << "]  ";
+  }
+  *os << "], output requests = [ ";
+  for ( int output = 0; output < _outputs; ++output ) {
+    if ( !out_req[output].empty( ) ) {
+      *os << output << " -> [ ";
+      for ( size_t r = 0; r < out_req[output].size( ); ++r ) {
+	*os << out_req[output][r].first << "@" << out_req[output][r].second 
+	    << " ";
+      }
+      *os << "]  ";
+    }
+  }
+  *os << "]." << endl;
+}
@@ -0,0 +1,104 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  HierarchicalAllocator: Separable allocator that only stores the 
+//  requests that were actually made
+//
+//  A VC allocator has one port per VC on each side, but every input VC
+//  only requests the handful of output VCs named in its route set. This
+//  allocator keeps a short request list per input and a round-robin 
+//  pointer per arbiter instead of a full request matrix and an arbiter
+//  object per port; it makes the same grants as the corresponding 
+//  separable allocator using round-robin arbiters.
+//
+// ----------------------------------------------------------------------
+
+#ifndef _HIERARCHICAL_HPP_
+#define _HIERARCHICAL_HPP_
+
+#include <vector>
+
+#include "allocator.hpp"
+
+class HierarchicalAllocator : public Allocator {
+
+  const bool _input_first;
+
+  // requests made by each input; the port field holds the output
+  vector<vector<sRequest> > _in_req;
+  vector<int> _out_reqs;
+
+  vector<int> _in_occ;
+  vector<int> _out_occ;
+
+  // round-robin pointers of the input and output arbiters
+  vector<int> _in_ptr;
+  vector<int> _out_ptr;
+
+  // per-allocation winners of the first arbitration stage
+  vector<int> _out_winner;
+  vector<int> _out_winner_pri;
+  vector<int> _out_winner_in_pri;
+  vector<int> _in_winner;
+  vector<int> _in_winner_pri;
+
+  vector<int> _out_touched;
+  vector<int> _in_touched;
+
+  void _AllocateInputFirst( );
+  void _AllocateOutputFirst( );
+
+  virtual void _Serialize( Checkpoint & cp );
+
+public:
+  HierarchicalAllocator( Module *parent, const string& name,
+			 int inputs, int outputs, bool input_first );
+
+  void Clear( );
+  
+  int  ReadRequest( int in, int out ) const;
+  bool ReadRequest( sRequest &req, int in, int out ) const;
+
+  void AddRequest( int in, int out, int label = 1, 
+		   int in_pri = 0, int out_pri = 0 );
+  void RemoveRequest( int in, int out, int label = 1 );
+
+  void Allocate( );
+
+  bool OutputHasRequests( int out ) const;
+  bool InputHasRequests( int in ) const;
+
+  int NumOutputRequests( int out ) const;
+  int NumInputRequests( int in ) const;
+
+  void PrintRequests( ostream * os = NULL ) const;
+
+};
+
+#endif
@@ -29,17 +29,33 @@
 #include <iostream>
 
 #include "islip.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
+#include "misc_utils.hpp"
 
 //#define DEBUG_ISLIP
 
 iSLIP_Sparse::iSLIP_Sparse( Module *parent, const string& name,
 			    int inputs, int outputs, int iters ) :
-  SparseAllocator( parent, name, inputs, outputs ),
+  BitsetAllocator( parent, name, inputs, outputs ),
   _iSLIP_iter(iters)
 {
   _gptrs.resize(_outputs, 0);
   _aptrs.resize(_inputs, 0);
+
+  _unmatched.resize(_out_words);
+  _candidates.resize(_out_words);
+  _granted.resize(_inputs * _in_words, 0);
+}
+
+void iSLIP_Sparse::_Serialize( Checkpoint & cp )
+{
+  BitsetAllocator::_Serialize( cp );
+  cp.Value( _gptrs );
+  cp.Value( _aptrs );
+  cp.Value( _unmatched );
+  cp.Value( _candidates );
+  cp.Value( _granted );
 }
 
 void iSLIP_Sparse::Allocate( )
@@ -47,58 +63,41 @@ void iSLIP_Sparse::Allocate( )
   int input;
   int output;
 
-  int input_offset;
-  int output_offset;
-
-  map<int, sRequest>::iterator p;
-  bool wrapped;
+  for ( input = 0; input < _inputs; ++input ) {
+    if ( _inmatch[input] == -1 ) {
+      _unmatched[input / 64] |= 1ULL << ( input % 64 );
+    } else {
+      _unmatched[input / 64] &= ~( 1ULL << ( input % 64 ) );
+    }
+  }
 
   for ( int iter = 0; iter < _iSLIP_iter; ++iter ) {
     // Grant phase
 
     vector<int> grants(_outputs, -1);
 
-    for ( output = 0; output < _outputs; ++output ) {
+    for ( int w = 0; w < _in_words; ++w ) {
+      unsigned long long outputs = _out_occ[w];
+      while ( outputs ) {
+	output = w * 64 + __builtin_ctzll(outputs);
+	outputs &= outputs - 1;
 
-      // Skip loop if there are no requests
-      // or the output is already matched
-      if ( ( _out_req[output].empty( ) ) ||
-	   ( _outmatch[output] != -1 ) ) {
-	continue;
-      }
-
-      // A round-robin arbiter between input requests
-      input_offset = _gptrs[output];
-
-      p = _out_req[output].begin( );
-      while( ( p != _out_req[output].end( ) ) &&
-	     ( p->second.port < input_offset ) ) {
-	p++;
-      }
-
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _out_req[output].end( ) ) &&
-	       ( p->second.port < input_offset ) ) ) {
-	if ( p == _out_req[output].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _out_req[output].begin( );
-	  wrapped = true;
+	// Skip if the output is already matched
+	if ( _outmatch[output] != -1 ) {
+	  continue;
 	}
 
-	input = p->second.port;
+	// A round-robin arbiter between requests from free inputs
+	for ( int v = 0; v < _out_words; ++v ) {
+	  _candidates[v] = _out_req[output * _out_words + v] & _unmatched[v];
+	}
+	input = first_set_bit(&_candidates[0], _inputs, _gptrs[output]);
 
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( _inmatch[input] == -1 ) {
+	if ( input >= 0 ) {
 	  grants[output] = input;
-	  break;
+	  _granted[input * _in_words + output / 64] |= 1ULL << ( output % 64 );
 	}
-
-	p++;
-      }      
+      }
     }
 
 #ifdef DEBUG_ISLIP
@@ -117,41 +116,21 @@ void iSLIP_Sparse::Allocate( )
 
     // Accept phase
 
-    for ( input = 0; input < _inputs; ++input ) {
-
-      if ( _in_req[input].empty( ) ) {
-	continue;
-      }
-
-      // A round-robin arbiter between output grants
-      output_offset = _aptrs[input];
-
-      p = _in_req[input].begin( );
-      while( ( p != _in_req[input].end( ) ) &&
-	     ( p->second.port < output_offset ) ) {
-	p++;
-      }
-
-      wrapped = false;
-      while( (!wrapped) || 
-	     ( ( p != _in_req[input].end( ) ) &&
-	       ( p->second.port < output_offset ) ) ) {
-	if ( p == _in_req[input].end( ) ) {
-	  if ( wrapped ) { break; }
-	  // p is valid here because empty lists
-	  // are skipped (above)
-	  p = _in_req[input].begin( );
-	  wrapped = true;
-	}
+    for ( int w = 0; w < _out_words; ++w ) {
+      unsigned long long inputs = _in_occ[w];
+      while ( inputs ) {
+	input = w * 64 + __builtin_ctzll(inputs);
+	inputs &= inputs - 1;
 
-	output = p->second.port;
+	// A round-robin arbiter between output grants
+	unsigned long long * granted = &_granted[input * _in_words];
+	output = first_set_bit(granted, _outputs, _aptrs[input]);
 
-	// we know the output is free (above) and
-	// if the input is free, grant request
-	if ( grants[output] == input ) {
+	if ( output >= 0 ) {
 	  // Accept
 	  _inmatch[input]   = output;
 	  _outmatch[output] = input;
+	  _unmatched[input / 64] &= ~( 1ULL << ( input % 64 ) );
 
 	  // Only update pointers if accepted during the 1st iteration
 	  if ( iter == 0 ) {
@@ -159,11 +138,11 @@ void iSLIP_Sparse::Allocate( )
 	    _aptrs[input]  = ( output + 1 ) % _outputs;
 	  }
 
-	  break;
+	  for ( int v = 0; v < _in_words; ++v ) {
+	    granted[v] = 0;
+	  }
 	}
-
-	p++;
-      } 
+      }
     }
   }
 
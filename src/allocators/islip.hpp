@@ -32,12 +32,18 @@
 
 #include "allocator.hpp"
 
-class iSLIP_Sparse : public SparseAllocator {
+class iSLIP_Sparse : public BitsetAllocator {
   int _iSLIP_iter;
 
   vector<int> _gptrs;
   vector<int> _aptrs;
 
+  vector<unsigned long long> _unmatched;
+  vector<unsigned long long> _candidates;
+  vector<unsigned long long> _granted;
+
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   iSLIP_Sparse( Module *parent, const string& name,
 		int inputs, int outputs, int iters );
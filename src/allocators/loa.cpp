@@ -29,19 +29,32 @@
 #include <iostream>
 
 #include "loa.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
+#include "misc_utils.hpp"
 
 LOA::LOA( Module *parent, const string& name,
 	  int inputs, int outputs ) :
-  DenseAllocator( parent, name, inputs, outputs )
+  BitsetAllocator( parent, name, inputs, outputs )
 {
   _req.resize(inputs);
   _counts.resize(outputs);
+  _req_mask.resize(_outputs * _out_words, 0);
 
   _rptr.resize(inputs);
   _gptr.resize(outputs);
 }
 
+void LOA::_Serialize( Checkpoint & cp )
+{
+  BitsetAllocator::_Serialize( cp );
+  cp.Value( _counts );
+  cp.Value( _req );
+  cp.Value( _req_mask );
+  cp.Value( _rptr );
+  cp.Value( _gptr );
+}
+
 void LOA::Allocate( )
 {
   int input;
@@ -57,10 +70,7 @@ void LOA::Allocate( )
   // per output is counted
 
   for ( int j = 0; j < _outputs; ++j ) {
-    _counts[j] = 0;
-    for ( int i = 0; i < _inputs; ++i ) {
-      _counts[j] += ( _request[i][j].label != -1 ) ? 1 : 0;
-    }
+    _counts[j] = NumOutputRequests(j);
   }
 
   // Request phase
@@ -71,42 +81,48 @@ void LOA::Allocate( )
     lonely        = -1;
     lonely_cnt    = _inputs + 1;
 
-    for ( int o = 0; o < _outputs; ++o ) {
-      output = ( o + output_offset ) % _outputs;
-
-      if ( ( _request[input][output].label != -1 ) && 
-	   ( _counts[output] < lonely_cnt ) ) {
+    const unsigned long long * row = &_in_req[input * _in_words];
+    const int first = first_set_bit(row, _outputs, output_offset);
+    output = first;
+    while ( output >= 0 ) {
+      if ( _counts[output] < lonely_cnt ) {
 	lonely = output;
 	lonely_cnt = _counts[output];
       }
+      output = first_set_bit(row, _outputs, ( output + 1 ) % _outputs);
+      if ( output == first ) {
+	break;
+      }
     }
 
     // Request the lonely output (-1 for no request)
     _req[input] = lonely;
+    if ( lonely >= 0 ) {
+      _req_mask[lonely * _out_words + input / 64] |= 1ULL << ( input % 64 );
+    }
   }
 
   // Grant phase
   for ( output = 0; output < _outputs; ++output ) {
     input_offset = _gptr[output];
 
-    for ( int i = 0; i < _inputs; ++i ) {
-      input = ( i + input_offset ) % _inputs;  
+    unsigned long long * requests = &_req_mask[output * _out_words];
+    input = first_set_bit(requests, _inputs, input_offset);
       
-      if ( _req[input] == output ) {
-	// Grant!
-	
-	_inmatch[input]   = output;
-	_outmatch[output] = input;
+    if ( input >= 0 ) {
+      // Grant!
 	
-	_rptr[input] = ( _rptr[input] + 1 ) % _outputs;
-	_gptr[output] = ( _gptr[output] + 1 ) % _inputs;
+      _inmatch[input]   = output;
+      _outmatch[output] = input;
 	
-	break;
+      _rptr[input] = ( _rptr[input] + 1 ) % _outputs;
+      _gptr[output] = ( _gptr[output] + 1 ) % _inputs;
+
+      for ( int v = 0; v < _out_words; ++v ) {
+	requests[v] = 0;
       }
     }
   }
 
 
 }
-
-
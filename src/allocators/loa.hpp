@@ -32,13 +32,16 @@
 
 #include "allocator.hpp"
 
-class LOA : public DenseAllocator {
+class LOA : public BitsetAllocator {
   vector<int> _counts;
   vector<int> _req;
+  vector<unsigned long long> _req_mask;
 
   vector<int> _rptr;
   vector<int> _gptr;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   LOA( Module *parent, const string& name,
        int inputs, int outputs );
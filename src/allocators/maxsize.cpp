@@ -33,6 +33,7 @@
 #include <iostream>
 
 #include "maxsize.hpp"
+#include "checkpoint.hpp"
 
 // shortest augmenting path:
 //
@@ -78,6 +79,13 @@ MaxSizeMatch::MaxSizeMatch( Module *parent, const string& name,
   _prio = 0;
 }
 
+void MaxSizeMatch::_Serialize( Checkpoint & cp )
+{
+  DenseAllocator::_Serialize( cp );
+  cp.Value( _from );
+  cp.Value( _prio );
+}
+
 MaxSizeMatch::~MaxSizeMatch( )
 {
   delete [] _s;
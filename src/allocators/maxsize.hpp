@@ -40,6 +40,8 @@ class MaxSizeMatch : public DenseAllocator {
  
   bool _ShortestAugmenting( );
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   MaxSizeMatch( Module *parent, const string& name,
 		int inputs, int ouputs ); 
@@ -29,15 +29,28 @@
 #include <iostream>
 
 #include "pim.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
+#include "misc_utils.hpp"
 
 //#define DEBUG_PIM
 
 PIM::PIM( Module *parent, const string& name,
 	  int inputs, int outputs, int iters ) :
-  DenseAllocator( parent, name, inputs, outputs ),
+  BitsetAllocator( parent, name, inputs, outputs ),
   _PIM_iter(iters)
 {
+  _unmatched.resize(_out_words);
+  _candidates.resize(_out_words);
+  _granted.resize(_inputs * _in_words, 0);
+}
+
+void PIM::_Serialize( Checkpoint & cp )
+{
+  BitsetAllocator::_Serialize( cp );
+  cp.Value( _unmatched );
+  cp.Value( _candidates );
+  cp.Value( _granted );
 }
 
 PIM::~PIM( )
@@ -52,28 +65,35 @@ void PIM::Allocate( )
   int input_offset;
   int output_offset;
 
+  for ( input = 0; input < _inputs; ++input ) {
+    if ( _inmatch[input] == -1 ) {
+      _unmatched[input / 64] |= 1ULL << ( input % 64 );
+    } else {
+      _unmatched[input / 64] &= ~( 1ULL << ( input % 64 ) );
+    }
+  }
+
   for ( int iter = 0; iter < _PIM_iter; ++iter ) {
     // Grant phase --- outputs randomly choose
     // between one of their requests
 
-    vector<int> grants(_outputs, -1);
-
     for ( output = 0; output < _outputs; ++output ) {
       
       // A random arbiter between input requests
       input_offset  = RandomInt( _inputs - 1 );
       
-      for ( int i = 0; i < _inputs; ++i ) {
-	input = ( i + input_offset ) % _inputs;  
-	
-	if ( ( _request[input][output].label != -1 ) && 
-	     ( _inmatch[input] == -1 ) &&
-	     ( _outmatch[output] == -1 ) ) {
-	  
-	  // Grant
-	  grants[output] = input;
-	  break;
-	}
+      if ( _outmatch[output] != -1 ) {
+	continue;
+      }
+
+      for ( int v = 0; v < _out_words; ++v ) {
+	_candidates[v] = _out_req[output * _out_words + v] & _unmatched[v];
+      }
+      input = first_set_bit(&_candidates[0], _inputs, input_offset);
+
+      if ( input >= 0 ) {
+	// Grant
+	_granted[input * _in_words + output / 64] |= 1ULL << ( output % 64 );
       }
     }
   
@@ -84,17 +104,19 @@ void PIM::Allocate( )
       
       // A random arbiter between output grants
       output_offset  = RandomInt( _outputs - 1 );
+
+      unsigned long long * granted = &_granted[input * _in_words];
+      output = first_set_bit(granted, _outputs, output_offset);
       
-      for ( int o = 0; o < _outputs; ++o ) {
-	output = ( o + output_offset ) % _outputs;
-	
-	if ( grants[output] == input ) {
+      if ( output >= 0 ) {
 	  
-	  // Accept
-	  _inmatch[input]   = output;
-	  _outmatch[output] = input;
-	  
-	  break;
+	// Accept
+	_inmatch[input]   = output;
+	_outmatch[output] = input;
+	_unmatched[input / 64] &= ~( 1ULL << ( input % 64 ) );
+
+	for ( int v = 0; v < _in_words; ++v ) {
+	  granted[v] = 0;
 	}
       }
     }
@@ -32,9 +32,15 @@
 
 #include "allocator.hpp"
 
-class PIM : public DenseAllocator {
+class PIM : public BitsetAllocator {
   int _PIM_iter;
 
+  vector<unsigned long long> _unmatched;
+  vector<unsigned long long> _candidates;
+  vector<unsigned long long> _granted;
+
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   PIM( Module *parent, const string& name,
        int inputs, int outputs, int iters );
@@ -29,6 +29,7 @@
 #include <iostream>
 
 #include "selalloc.hpp"
+#include "checkpoint.hpp"
 #include "random_utils.hpp"
 
 //#define DEBUG_SELALLOC
@@ -44,6 +45,14 @@ SelAlloc::SelAlloc( Module *parent, const string& name,
   _outmask.resize(outputs, 0);
 }
 
+void SelAlloc::_Serialize( Checkpoint & cp )
+{
+  SparseAllocator::_Serialize( cp );
+  cp.Value( _aptrs );
+  cp.Value( _gptrs );
+  cp.Value( _outmask );
+}
+
 void SelAlloc::Allocate( )
 {
   int input;
@@ -40,6 +40,8 @@ class SelAlloc : public SparseAllocator {
 
   vector<int> _outmask;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   SelAlloc( Module *parent, const string& name,
 	    int inputs, int outputs, int iters );
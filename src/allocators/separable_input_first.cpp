@@ -48,56 +48,58 @@ SeparableInputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableInputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
-    
-    const int & input = *port_iter;
-
-    // add requests to the input arbiter
-
-    map<int, sRequest>::const_iterator req_iter = _in_req[input].begin();
-    while(req_iter != _in_req[input].end()) {
+  for(int w = 0; w < _out_words; ++w) {
+    unsigned long long inputs = _in_occ[w];
+    while(inputs) {
 
-      const sRequest & req = req_iter->second;
-      
-      _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
+      const int input = w * 64 + __builtin_ctzll(inputs);
+      inputs &= inputs - 1;
 
-      ++req_iter;
-    }
+      // add requests to the input arbiter
 
-    // Execute the input arbiters and propagate the grants to the
-    // output arbiters.
+      for(int v = 0; v < _in_words; ++v) {
+	unsigned long long outputs = _in_req[input * _in_words + v];
+	while(outputs) {
+	  const int output = v * 64 + __builtin_ctzll(outputs);
+	  outputs &= outputs - 1;
+	  const sRequest & req = _Info(input, output);
+	  _input_arb[input]->AddRequest(output, req.label, req.in_pri);
+	}
+      }
 
-    int label = -1;
-    const int output = _input_arb[input]->Arbitrate(&label, NULL);
-    assert(output > -1);
+      // Execute the input arbiters and propagate the grants to the
+      // output arbiters.
 
-    const sRequest & req = _out_req[output][input]; 
-    assert((req.port == input) && (req.label == label));
+      int label = -1;
+      const int output = _input_arb[input]->Arbitrate(&label, NULL);
+      assert(output > -1);
 
-    _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
+      const sRequest & req = _Info(input, output);
+      assert(req.label == label);
 
-    ++port_iter;
+      _output_arb[output]->AddRequest(input, label, req.out_pri);
+    }
   }
 
-  port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
+  for(int w = 0; w < _in_words; ++w) {
+    unsigned long long outputs = _out_occ[w];
+    while(outputs) {
 
-    const int & output = *port_iter;
+      const int output = w * 64 + __builtin_ctzll(outputs);
+      outputs &= outputs - 1;
 
-    // Execute the output arbiters.
+      // Execute the output arbiters.
     
-    const int input = _output_arb[output]->Arbitrate(NULL, NULL);
+      const int input = _output_arb[output]->Arbitrate(NULL, NULL);
 
-    if(input > -1) {
-      assert((_inmatch[input] == -1) && (_outmatch[output] == -1));
+      if(input > -1) {
+	assert((_inmatch[input] == -1) && (_outmatch[output] == -1));
 
-      _inmatch[input] = output ;
-      _outmatch[output] = input ;
-      _input_arb[input]->UpdateState() ;
-      _output_arb[output]->UpdateState() ;
+	_inmatch[input] = output ;
+	_outmatch[output] = input ;
+	_input_arb[input]->UpdateState() ;
+	_output_arb[output]->UpdateState() ;
+      }
     }
-
-    ++port_iter;
   }
 }
@@ -48,56 +48,58 @@ SeparableOutputFirstAllocator( Module* parent, const string& name, int inputs,
 
 void SeparableOutputFirstAllocator::Allocate() {
   
-  set<int>::const_iterator port_iter = _out_occ.begin();
-  while(port_iter != _out_occ.end()) {
+  for(int w = 0; w < _in_words; ++w) {
+    unsigned long long outputs = _out_occ[w];
+    while(outputs) {
+
+      const int output = w * 64 + __builtin_ctzll(outputs);
+      outputs &= outputs - 1;
+
+      // add requests to the output arbiter
+
+      for(int v = 0; v < _out_words; ++v) {
+	unsigned long long inputs = _out_req[output * _out_words + v];
+	while(inputs) {
+	  const int input = v * 64 + __builtin_ctzll(inputs);
+	  inputs &= inputs - 1;
+	  const sRequest & req = _Info(input, output);
+	  _output_arb[output]->AddRequest(input, req.label, req.out_pri);
+	}
+      }
     
-    const int & output = *port_iter;
+      // Execute the output arbiter and propagate the grants to the
+      // input arbiters.
 
-    // add requests to the output arbiter
+      int label = -1;
+      const int input = _output_arb[output]->Arbitrate(&label, NULL);
+      assert(input > -1);
 
-    map<int, sRequest>::const_iterator req_iter = _out_req[output].begin();
-    while(req_iter != _out_req[output].end()) {
-      
-      const sRequest & req = req_iter->second;
+      const sRequest & req = _Info(input, output);
+      assert(req.label == label);
 
-      _output_arb[output]->AddRequest(req.port, req.label, req.out_pri);
-
-      ++req_iter;
+      _input_arb[input]->AddRequest(output, label, req.in_pri);
     }
-    
-    // Execute the output arbiter and propagate the grants to the
-    // input arbiters.
-
-    int label = -1;
-    const int input = _output_arb[output]->Arbitrate(&label, NULL);
-    assert(input > -1);
-
-    const sRequest & req = _in_req[input][output];
-    assert((req.port == output) && (req.label == label));
-
-    _input_arb[input]->AddRequest(req.port, req.label, req.in_pri);
-
-    ++port_iter;
   }
   
-  port_iter = _in_occ.begin();
-  while(port_iter != _in_occ.end()) {
+  for(int w = 0; w < _out_words; ++w) {
+    unsigned long long inputs = _in_occ[w];
+    while(inputs) {
     
-    const int & input = *port_iter;
+      const int input = w * 64 + __builtin_ctzll(inputs);
+      inputs &= inputs - 1;
 
-    // Execute the input arbiters.
+      // Execute the input arbiters.
     
-    const int output = _input_arb[input]->Arbitrate(NULL, NULL);
+      const int output = _input_arb[input]->Arbitrate(NULL, NULL);
   
-    if(output > -1) {
-      assert((_inmatch[input] == -1) && (_outmatch[output] == -1));
-
-      _inmatch[input] = output;
-      _outmatch[output] = input;
-      _input_arb[input]->UpdateState() ;
-      _output_arb[output]->UpdateState() ;
+      if(output > -1) {
+	assert((_inmatch[input] == -1) && (_outmatch[output] == -1));
+
+	_inmatch[input] = output;
+	_outmatch[output] = input;
+	_input_arb[input]->UpdateState() ;
+	_output_arb[output]->UpdateState() ;
+      }
     }
-    
-    ++port_iter;
   }
 }
@@ -33,6 +33,7 @@
 #include "booksim.hpp"
 
 #include "wavefront.hpp"
+#include "checkpoint.hpp"
 
 Wavefront::Wavefront( Module *parent, const string& name,
 		      int inputs, int outputs, bool skip_diags ) :
@@ -42,6 +43,16 @@ Wavefront::Wavefront( Module *parent, const string& name,
 {
 }
 
+void Wavefront::_Serialize( Checkpoint & cp )
+{
+  DenseAllocator::_Serialize( cp );
+  cp.Value( _last_in );
+  cp.Value( _last_out );
+  cp.Value( _priorities );
+  cp.Value( _pri );
+  cp.Value( _num_requests );
+}
+
 void Wavefront::AddRequest( int in, int out, int label, 
 			    int in_pri, int out_pri )
 {
@@ -45,6 +45,8 @@ protected:
   int _pri;
   int _num_requests;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   Wavefront( Module *parent, const string& name,
 	     int inputs, int outputs, bool skip_diags = false );
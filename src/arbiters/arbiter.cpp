@@ -32,9 +32,11 @@
 // ----------------------------------------------------------------------
 
 #include "arbiter.hpp"
+#include "checkpoint.hpp"
 #include "roundrobin_arb.hpp"
 #include "matrix_arb.hpp"
 #include "tree_arb.hpp"
+#include "bitmask_matrix_arb.hpp"
 
 #include <limits>
 #include <cassert>
@@ -51,6 +53,16 @@ Arbiter::Arbiter( Module *parent, const string &name, int size )
     _request[i].valid = false ;
 }
 
+void Arbiter::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "arbiter size", _size );
+  cp.Value( _request );
+  cp.Value( _selected );
+  cp.Value( _highest_pri );
+  cp.Value( _best_input );
+  cp.Value( _num_reqs );
+}
+
 void Arbiter::AddRequest( int input, int id, int pri )
 {
   assert( 0 <= input && input < _size ) ;
@@ -96,6 +108,8 @@ Arbiter *Arbiter::NewArbiter( Module *parent, const string& name,
     a = new RoundRobinArbiter( parent, name, size );
   } else if(arb_type == "matrix") {
     a = new MatrixArbiter( parent, name, size );
+  } else if(arb_type == "bitmask_matrix") {
+    a = new BitmaskMatrixArbiter( parent, name, size );
   } else if(arb_type.substr(0, 5) == "tree(") {
     size_t left = 4;
     size_t middle = arb_type.find_first_of(',');
@@ -55,6 +55,8 @@ protected:
   int _highest_pri;
   int _best_input;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   int  _num_reqs ;
   // Constructors
@@ -0,0 +1,91 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitmaskArbiter: Base class for arbiters that keep their requests in
+//  a bit vector
+//
+// ----------------------------------------------------------------------
+
+#include "bitmask_arb.hpp"
+#include "checkpoint.hpp"
+
+#include <cassert>
+
+using namespace std ;
+
+BitmaskArbiter::BitmaskArbiter( Module *parent, const string &name,
+				int size )
+  : Arbiter( parent, name, size ), _words( ( size + 63 ) / 64 )
+{
+  _req_bits.resize(_words, 0);
+  _top_bits.resize(_words, 0);
+}
+
+void BitmaskArbiter::_Serialize( Checkpoint & cp )
+{
+  Arbiter::_Serialize( cp );
+  cp.Value( _req_bits );
+  cp.Value( _top_bits );
+}
+
+void BitmaskArbiter::AddRequest( int input, int id, int pri )
+{
+  assert( 0 <= input && input < _size ) ;
+
+  unsigned long long const bit = 1ULL << ( input % 64 ) ;
+
+  // a request at a higher priority than all previous ones masks them out
+  if ( ( _num_reqs == 0 ) || ( pri > _highest_pri ) ) {
+    _highest_pri = pri ;
+    for ( int w = 0 ; w < _words ; ++w ) {
+      _top_bits[w] = 0 ;
+    }
+  }
+  if ( pri == _highest_pri ) {
+    _top_bits[input / 64] |= bit ;
+  }
+  _req_bits[input / 64] |= bit ;
+  Arbiter::AddRequest(input, id, pri);
+}
+
+void BitmaskArbiter::Clear()
+{
+  if(_num_reqs > 0) {
+
+    // only visit the inputs that actually made a request
+    for ( int w = 0 ; w < _words ; ++w ) {
+      for ( unsigned long long bits = _req_bits[w] ; bits ; bits &= bits - 1 ) {
+	_request[w * 64 + __builtin_ctzll(bits)].valid = false ;
+      }
+      _req_bits[w] = 0 ;
+    }
+    _num_reqs = 0 ;
+    _selected = -1;
+  }
+}
@@ -0,0 +1,69 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitmaskArbiter: Base class for arbiters that keep their requests in
+//  a bit vector
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITMASK_ARB_HPP_
+#define _BITMASK_ARB_HPP_
+
+#include <vector>
+
+#include "arbiter.hpp"
+
+class BitmaskArbiter : public Arbiter {
+
+protected:
+
+  int _words ;
+
+  // Pending requests, one bit per input
+  vector<unsigned long long> _req_bits ;
+
+  // Requests at the highest priority seen so far; only these are
+  // eligible to win the current arbitration
+  vector<unsigned long long> _top_bits ;
+
+  virtual void _Serialize( Checkpoint & cp );
+
+public:
+
+  // Constructors
+  BitmaskArbiter( Module *parent, const string &name, int size ) ;
+
+  // Register request with arbiter
+  virtual void AddRequest( int input, int id, int pri ) ;
+
+  virtual void Clear();
+
+} ;
+
+#endif
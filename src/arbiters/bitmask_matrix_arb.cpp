@@ -0,0 +1,121 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitmaskMatrix: Matrix Arbiter using a packed priority matrix
+//
+// ----------------------------------------------------------------------
+
+#include "bitmask_matrix_arb.hpp"
+#include "checkpoint.hpp"
+#include "misc_utils.hpp"
+#include <iostream>
+using namespace std ;
+
+BitmaskMatrixArbiter::BitmaskMatrixArbiter( Module *parent,
+					    const string &name, int size )
+  : BitmaskArbiter( parent, name, size ) {
+  _columns.resize(size * _words, 0);
+  for ( int j = 0 ; j < size ; j++ ) {
+    for ( int i = j + 1; i < size ; i++ ) {
+      _columns[j * _words + i / 64] |= 1ULL << ( i % 64 ) ;
+    }
+  }
+}
+
+void BitmaskMatrixArbiter::_Serialize( Checkpoint & cp )
+{
+  BitmaskArbiter::_Serialize( cp );
+  cp.Value( _columns );
+}
+
+void BitmaskMatrixArbiter::PrintState() const  {
+  cout << "Priority Matrix: " << endl ;
+  for ( int r = 0; r < _size ; r++ ) {
+    for ( int c = 0 ; c < _size ; c++ ) {
+      cout << ( ( _columns[c * _words + r / 64] >> ( r % 64 ) ) & 1 ) << " " ;
+    }
+    cout << endl ;
+  }
+  cout << endl ;
+}
+
+void BitmaskMatrixArbiter::UpdateState() {
+  // update priority matrix using last grant
+  if ( _selected > -1 ) {
+    int const word = _selected / 64 ;
+    unsigned long long const bit = 1ULL << ( _selected % 64 ) ;
+    for ( int i = 0; i < _size ; i++ ) {
+      _columns[i * _words + word] &= ~bit ;
+    }
+    unsigned long long * column = &_columns[_selected * _words] ;
+    for ( int w = 0; w < _words ; w++ ) {
+      int const bits = _size - w * 64 ;
+      column[w] = ( bits >= 64 ) ? ~0ULL : ( ( 1ULL << bits ) - 1 ) ;
+    }
+    column[word] &= ~bit ;
+  }
+}
+
+int BitmaskMatrixArbiter::Arbitrate( int* id, int* pri ) {
+  
+  // avoid running arbiter if it has not recevied at least two requests
+  // (in this case, requests and grants are identical)
+  if ( _num_reqs < 2 ) {
+    
+    _selected = ( _num_reqs > 0 ) ? first_set_bit(&_req_bits[0], _size, 0) : -1 ;
+    
+  } else {
+
+    // grant the eligible request whose column has no other eligible 
+    // request in it
+    const unsigned long long * candidates = &_top_bits[0] ;
+
+    _selected = -1 ;
+
+    for ( int w = 0 ; ( w < _words ) && ( _selected < 0 ) ; w++ ) {
+      for ( unsigned long long bits = candidates[w] ; bits ; bits &= bits - 1 ) {
+	int const input = w * 64 + __builtin_ctzll(bits) ;
+	const unsigned long long * column = &_columns[input * _words] ;
+	bool grant = true ;
+	for ( int v = 0 ; v < _words ; v++ ) {
+	  if ( candidates[v] & column[v] ) {
+	    grant = false ;
+	    break ;
+	  }
+	}
+	if ( grant ) {
+	  _selected = input ;
+	  break ;
+	}
+      }
+    }
+  }
+    
+  return Arbiter::Arbitrate(id, pri);
+}
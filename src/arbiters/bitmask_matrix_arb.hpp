@@ -0,0 +1,68 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// ----------------------------------------------------------------------
+//
+//  BitmaskMatrix: Matrix Arbiter using a packed priority matrix
+//
+// ----------------------------------------------------------------------
+
+#ifndef _BITMASK_MATRIX_ARB_HPP_
+#define _BITMASK_MATRIX_ARB_HPP_
+
+#include <vector>
+
+#include "bitmask_arb.hpp"
+
+using namespace std;
+
+class BitmaskMatrixArbiter : public BitmaskArbiter {
+
+  // Priority matrix, stored by column: bit i of column j is set if 
+  // input i has priority over input j
+  vector<unsigned long long> _columns ;
+
+  virtual void _Serialize( Checkpoint & cp );
+
+public:
+
+  // Constructors
+  BitmaskMatrixArbiter( Module *parent, const string &name, int size ) ;
+
+  // Print priority matrix to standard output
+  virtual void PrintState() const ;
+  
+  // Update priority matrix based on last aribtration result
+  virtual void UpdateState() ; 
+
+  // Arbitrate amongst requests. Returns winning input and 
+  // updates pointers to metadata when valid pointers are passed
+  virtual int Arbitrate( int* id = 0, int* pri = 0) ;
+
+} ;
+
+#endif
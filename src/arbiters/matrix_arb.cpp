@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "matrix_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 using namespace std ;
 
@@ -46,6 +47,13 @@ MatrixArbiter::MatrixArbiter( Module *parent, const string &name, int size )
   }
 }
 
+void MatrixArbiter::_Serialize( Checkpoint & cp )
+{
+  Arbiter::_Serialize( cp );
+  cp.Value( _matrix );
+  cp.Value( _last_req );
+}
+
 void MatrixArbiter::PrintState() const  {
   cout << "Priority Matrix: " << endl ;
   for ( int r = 0; r < _size ; r++ ) {
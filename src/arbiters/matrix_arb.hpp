@@ -47,6 +47,8 @@ class MatrixArbiter : public Arbiter {
 
   int  _last_req ;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   // Constructors
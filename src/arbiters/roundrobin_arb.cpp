@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "roundrobin_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 #include <limits>
 
@@ -42,6 +43,12 @@ RoundRobinArbiter::RoundRobinArbiter( Module *parent, const string &name,
   : Arbiter( parent, name, size ), _pointer( 0 ) {
 }
 
+void RoundRobinArbiter::_Serialize( Checkpoint & cp )
+{
+  Arbiter::_Serialize( cp );
+  cp.Value( _pointer );
+}
+
 void RoundRobinArbiter::PrintState() const  {
   cout << "Round Robin Priority Pointer: " << endl ;
   cout << "  _pointer = " << _pointer << endl ;
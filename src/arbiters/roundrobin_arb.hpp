@@ -41,6 +41,8 @@ class RoundRobinArbiter : public Arbiter {
   // Priority pointer
   int  _pointer ;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
 
   // Constructors
@@ -32,6 +32,7 @@
 // ----------------------------------------------------------------------
 
 #include "tree_arb.hpp"
+#include "checkpoint.hpp"
 #include <iostream>
 #include <sstream>
 
@@ -42,7 +43,7 @@ TreeArbiter::TreeArbiter( Module *parent, const string &name,
   : Arbiter( parent, name, size ) {
   assert(size % groups == 0);
   _group_arbiters.resize(groups);
-  _group_reqs.resize(groups, 0);
+  _group_reqs.resize(( groups + 63 ) / 64, 0);
   _group_size = size / groups;
   for(int i = 0; i < groups; ++i) {
     ostringstream group_arb_name;
@@ -52,6 +53,12 @@ TreeArbiter::TreeArbiter( Module *parent, const string &name,
   _global_arbiter = Arbiter::NewArbiter(this, "global_arb", arb_type, groups);
 }
 
+void TreeArbiter::_Serialize( Checkpoint & cp )
+{
+  Arbiter::_Serialize( cp );
+  cp.Value( _group_reqs );
+}
+
 TreeArbiter::~TreeArbiter() {
   for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
     delete _group_arbiters[i];
@@ -82,15 +89,16 @@ void TreeArbiter::AddRequest( int input, int id, int pri )
   Arbiter::AddRequest(input, id, pri);
   int group_index = input / _group_size;
   _group_arbiters[group_index]->AddRequest( input % _group_size, id, pri );
-  ++_group_reqs[group_index];
+  _group_reqs[group_index / 64] |= 1ULL << ( group_index % 64 );
 }
 
 int TreeArbiter::Arbitrate( int* id, int* pri ) {
   if(!_num_reqs) {
     return -1;
   } 
-  for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
-    if(_group_reqs[i]) {
+  for(int w = 0; w < (int)_group_reqs.size(); ++w) {
+    for(unsigned long long bits = _group_reqs[w]; bits; bits &= bits - 1) {
+      int i = w * 64 + __builtin_ctzll(bits);
       int group_id, group_pri;
       _group_arbiters[i]->Arbitrate(&group_id, &group_pri);
       _global_arbiter->AddRequest(i, group_id, group_pri);
@@ -110,9 +118,11 @@ void TreeArbiter::Clear()
   if(!_num_reqs) {
     return;
   }
-  for(int i = 0; i < (int)_group_arbiters.size(); ++i) {
-    _group_arbiters[i]->Clear();
-    _group_reqs[i] = 0;
+  for(int w = 0; w < (int)_group_reqs.size(); ++w) {
+    for(unsigned long long bits = _group_reqs[w]; bits; bits &= bits - 1) {
+      _group_arbiters[w * 64 + __builtin_ctzll(bits)]->Clear();
+    }
+    _group_reqs[w] = 0;
   }
   _global_arbiter->Clear();
   Arbiter::Clear();
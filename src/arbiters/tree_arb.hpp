@@ -43,7 +43,10 @@ class TreeArbiter : public Arbiter {
   vector<Arbiter *> _group_arbiters;
   Arbiter * _global_arbiter;
 
-  vector<int> _group_reqs;
+  // groups with pending requests, one bit per group
+  vector<unsigned long long> _group_reqs;
+
+  virtual void _Serialize( Checkpoint & cp );
 
 public:
 
@@ -42,6 +42,13 @@ BatchTrafficManager::BatchTrafficManager( const Configuration &config,
 
   _max_outstanding = config.GetInt ("max_outstanding_requests");  
 
+  if(!_checkpoint_out.empty() || !_checkpoint_in.empty()) {
+    Error("Checkpoints are not supported for batch simulations.");
+  }
+
+  // packets are issued based on the batch state, not the injection process
+  _skip_ahead.assign(_classes, false);
+
   _batch_size = config.GetInt( "batch_size" );
   _batch_count = config.GetInt( "batch_count" );
 
@@ -143,13 +150,11 @@ bool BatchTrafficManager::_SingleSim( )
     
     bool packets_left = false;
     for(int c = 0; c < _classes; ++c) {
-      packets_left |= !_total_in_flight_flits[c].empty();
+      packets_left |= (_total_in_flight_flits[c] > 0);
     }
     
     while( packets_left ) { 
-      _Step( ); 
-      
-      ++empty_steps;
+      empty_steps += _Advance( 1000 - empty_steps % 1000 ); 
       
       if ( empty_steps % 1000 == 0 ) {
 	_DisplayRemaining( ); 
@@ -158,7 +163,7 @@ bool BatchTrafficManager::_SingleSim( )
       
       packets_left = false;
       for(int c = 0; c < _classes; ++c) {
-	packets_left |= !_total_in_flight_flits[c].empty();
+	packets_left |= (_total_in_flight_flits[c] > 0);
       }
     }
     cout << endl;
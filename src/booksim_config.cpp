@@ -182,6 +182,10 @@ BookSimConfig::BookSimConfig( )
   _float_map["burst_beta"]  = 0.5; // burst length
   _float_map["burst_r1"] = -1.0; // burst rate
 
+  // sample the cycle in which each source injects next, rather than testing
+  // every source in every cycle (changes the random number draw order)
+  _int_map["skip_ahead_injection"] = 0;
+
   AddStrField( "priority", "none" );  // message priorities
 
   _int_map["batch_size"] = 1000;
@@ -225,6 +229,7 @@ BookSimConfig::BookSimConfig( )
   // types:
   //   latency    - average + latency distribution for a particular injection rate
   //   throughput - sustained throughput for a particular injection rate
+  //   sweep      - latency for a series of injection rates up to saturation
 
   AddStrField( "sim_type", "latency" );
 
@@ -243,20 +248,68 @@ BookSimConfig::BookSimConfig( )
   _float_map["latency_thres"] = 500.0;
   AddStrField("latency_thres", ""); // workaround to allow for vector specification
 
+  // if the source queues keep falling behind (and accepted throughput stays
+  // below the offered load) for this many sample periods, assume unstable
+  _int_map["saturation_periods"] = 0;
+  _float_map["saturation_thres"] = 0.05;
+
    // consider warmed up once relative change in latency / throughput between successive iterations is smaller than this
   _float_map["warmup_thres"] = 0.05;
   AddStrField("warmup_thres", ""); // workaround to allow for vector specification
   _float_map["acc_warmup_thres"] = 0.05;
   AddStrField("acc_warmup_thres", ""); // workaround to allow for vector specification
 
+  // if non-zero, instead find the end of the transient with MSER, averaging this many 
+  // sample periods per batch, and keep the statistics of the periods after it
+  _int_map["warmup_mser"] = 0;
+
   // consider converged once relative change in latency / throughput between successive iterations is smaller than this
   _float_map["stopping_thres"] = 0.05;
   AddStrField("stopping_thres", ""); // workaround to allow for vector specification
   _float_map["acc_stopping_thres"] = 0.05;
   AddStrField("acc_stopping_thres", ""); // workaround to allow for vector specification
 
+  // if non-negative, instead consider converged once the confidence interval of the
+  // mean latency / throughput, using each sample period as a batch, is narrower 
+  // than this fraction of the mean
+  _float_map["stopping_ci"] = -1.0;
+  AddStrField("stopping_ci", ""); // workaround to allow for vector specification
+  _float_map["stopping_ci_level"] = 0.95;
+  _int_map["stopping_ci_batches"] = 5; // minimum number of sample periods measured
+
   _int_map["sim_count"]     = 1;   // number of simulations to perform
 
+  // latency-throughput sweep (sim_type = sweep), see utils/sweep.sh
+  _float_map["sweep_initial_step"] = 0.05;
+  _float_map["sweep_minimum_step"] = 0.001;
+  _float_map["sweep_zero_load_rate"] = 0.0025; // rate for the zero-load latency
+  _int_map["sweep_backtrack"] = 1; // halve the step after an unstable point
+  _int_map["sweep_refine"] = 1; // add points where latency grows quickly
+  _int_map["sweep_warm_start"] = 0; // start each point from the previous one's traffic
+  AddStrField("sweep_out", ""); // file for the table of points (stdout if empty)
+  AddStrField("sweep_format", "csv"); // csv or json
+
+  _int_map["threads"] = 1; // number of threads used to evaluate each network
+
+  _int_map["parallel_subnets"] = 0; // step each subnet on its own thread
+
+  AddStrField("job_file", ""); // parameter overrides for a batch of simulations, one per line
+  _int_map["job_threads"] = 1; // number of simulations from job_file run concurrently
+
+  // save the complete simulation state once warmed up (or after checkpoint_at
+  // sample periods), and start from a saved state instead of an empty network
+  AddStrField("checkpoint_out", "");
+  _int_map["checkpoint_at"] = -1;
+  _int_map["checkpoint_exit"] = 0; // stop after saving the checkpoint
+  AddStrField("checkpoint_in", "");
+  _int_map["checkpoint_reseed"] = 0; // reseed the generator from seed after restoring
+
+  _int_map["wake_list"] = 1; // only evaluate routers and channels that have work to do
+
+  _int_map["timing_wheel"] = 0; // let channels sleep until their next delivery (requires wake_list)
+
+  _int_map["fast_forward"] = 1; // don't evaluate the network in cycles in which nothing happens
+
 
   _int_map["include_queuing"] =1; // non-zero includes source queuing latency
 
@@ -25,31 +25,67 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <limits>
 #include <sstream>
 
 #include "globals.hpp"
 #include "booksim.hpp"
 #include "buffer.hpp"
+#include "checkpoint.hpp"
 
 Buffer::Buffer( const Configuration& config, int outputs, 
 		Module *parent, const string& name ) :
 Module( parent, name ), _occupancy(0)
 {
-  int num_vcs = config.GetInt( "num_vcs" );
+  _vcs = config.GetInt( "num_vcs" );
 
   _size = config.GetInt("buf_size");
   if(_size < 0) {
-    _size = num_vcs * config.GetInt( "vc_buf_size" );
+    _size = _vcs * config.GetInt( "vc_buf_size" );
   };
 
-  _vc.resize(num_vcs);
+  int const vc_buf_size = config.GetInt( "vc_buf_size" );
+  _capacity = 1;
+  while((_capacity < vc_buf_size) && (_capacity < _size)) {
+    _capacity <<= 1;
+  }
+  _flits.resize(_vcs * _capacity, NULL);
+  _head.resize(_vcs, 0);
+  _count.resize(_vcs, 0);
+
+  _state.resize(_vcs, VC::idle);
+  _out_port.resize(_vcs, -1);
+  _out_vc.resize(_vcs, -1);
+  _pri.resize(_vcs, 0);
+  _expected_pid.resize(_vcs, -1);
+  _watched.resize(_vcs, false);
+
+  _lookahead_routing = !config.GetInt("routing_delay");
+  if(_lookahead_routing) {
+    _route_set.resize(_vcs, NULL);
+  } else {
+    _own_route_set.resize(_vcs);
+    _route_set.resize(_vcs);
+    for(int i = 0; i < _vcs; ++i) {
+      _route_set[i] = &_own_route_set[i];
+    }
+  }
 
-  for(int i = 0; i < num_vcs; ++i) {
-    ostringstream vc_name;
-    vc_name << "vc_" << i;
-    _vc[i] = new VC(config, outputs, this, vc_name.str( ) );
+  string priority = config.GetStr( "priority" );
+  if ( priority == "local_age" ) {
+    _pri_type = local_age_based;
+  } else if ( priority == "queue_length" ) {
+    _pri_type = queue_length_based;
+  } else if ( priority == "hop_count" ) {
+    _pri_type = hop_count_based;
+  } else if ( priority == "none" ) {
+    _pri_type = none;
+  } else {
+    _pri_type = other;
   }
 
+  _priority_donation = config.GetInt("vc_priority_donation");
+
 #ifdef TRACK_BUFFERS
   int classes = config.GetInt("classes");
   _class_occupancy.resize(classes, 0);
@@ -58,26 +94,225 @@ Module( parent, name ), _occupancy(0)
 
 Buffer::~Buffer()
 {
-  for(vector<VC*>::iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    delete *i;
-  }
 }
 
 void Buffer::AddFlit( int vc, Flit *f )
 {
+  assert(f);
+
   if(_occupancy >= _size) {
     Error("Flit buffer overflow.");
   }
   ++_occupancy;
-  _vc[vc]->AddFlit(f);
+
+  if(_expected_pid[vc] >= 0) {
+    if(f->pid != _expected_pid[vc]) {
+      ostringstream err;
+      err << "Received flit " << f->id << " with unexpected packet ID: " << f->pid 
+	  << " (expected: " << _expected_pid[vc] << ") at VC " << vc;
+      Error(err.str());
+    } else if(f->tail) {
+      _expected_pid[vc] = -1;
+    }
+  } else if(!f->tail) {
+    _expected_pid[vc] = f->pid;
+  }
+    
+  // update flit priority before adding to VC buffer
+  if(_pri_type == local_age_based) {
+    f->pri = numeric_limits<int>::max() - GetSimTime();
+    assert(f->pri >= 0);
+  } else if(_pri_type == hop_count_based) {
+    f->pri = f->hops;
+    assert(f->pri >= 0);
+  }
+
+  if(_count[vc] == _capacity) {
+    _Grow();
+  }
+  _flits[vc * _capacity + ((_head[vc] + _count[vc]) & (_capacity - 1))] = f;
+  ++_count[vc];
+  _UpdatePriority(vc);
+
 #ifdef TRACK_BUFFERS
   ++_class_occupancy[f->cl];
 #endif
 }
 
+Flit *Buffer::RemoveFlit( int vc )
+{
+  if(!_count[vc]) {
+    ostringstream err;
+    err << "Trying to remove flit from empty buffer at VC " << vc << ".";
+    Error(err.str());
+  }
+  --_occupancy;
+  Flit * const f = _flits[vc * _capacity + _head[vc]];
+#ifdef TRACK_BUFFERS
+  int cl = f->cl;
+  assert(_class_occupancy[cl] > 0);
+  --_class_occupancy[cl];
+#endif
+  _head[vc] = (_head[vc] + 1) & (_capacity - 1);
+  --_count[vc];
+  _UpdatePriority(vc);
+  return f;
+}
+
+void Buffer::SetState( int vc, VC::eVCState s )
+{
+  Flit * f = FrontFlit(vc);
+  
+  if(f && f->watch)
+    *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		<< "Changing state from " << VC::VCSTATE[_state[vc]]
+		<< " to " << VC::VCSTATE[s] << "." << endl;
+  
+  _state[vc] = s;
+}
+
+void Buffer::_Grow( )
+{
+  int const capacity = 2 * _capacity;
+  vector<Flit *> flits(_vcs * capacity, NULL);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    for(int i = 0; i < _count[vc]; ++i) {
+      flits[vc * capacity + i] = _Flit(vc, i);
+    }
+    _head[vc] = 0;
+  }
+  _flits.swap(flits);
+  _capacity = capacity;
+}
+
+void Buffer::_UpdatePriority( int vc )
+{
+  if(!_count[vc]) return;
+  if(_pri_type == queue_length_based) {
+    _pri[vc] = _count[vc];
+  } else if(_pri_type != none) {
+    Flit * f = FrontFlit(vc);
+    if((_pri_type != local_age_based) && _priority_donation) {
+      Flit * df = f;
+      for(int i = 1; i < _count[vc]; ++i) {
+	Flit * bf = _Flit(vc, i);
+	if(bf->pri > df->pri) df = bf;
+      }
+      if((df != f) && (df->watch || f->watch)) {
+	*gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		    << "Flit " << df->id
+		    << " donates priority to flit " << f->id
+		    << "." << endl;
+      }
+      f = df;
+    }
+    if(f->watch)
+      *gWatchOut << GetSimTime() << " | " << _VCName(vc) << " | "
+		  << "Flit " << f->id
+		  << " sets priority to " << f->pri
+		  << "." << endl;
+    _pri[vc] = f->pri;
+  }
+}
+
+string Buffer::_VCName( int vc ) const
+{
+  ostringstream name;
+  name << FullName() << "/vc_" << vc;
+  return name.str();
+}
+
+void Buffer::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "buffer size", _size );
+  cp.Check( "num_vcs", _vcs );
+  cp.Check( "lookahead routing", _lookahead_routing );
+  cp.Value( _occupancy );
+  cp.Value( _capacity );
+  cp.Value( _count );
+  if ( cp.Restoring( ) ) {
+    _flits.assign( _vcs * _capacity, NULL );
+    _head.assign( _vcs, 0 );
+  }
+  for ( int vc = 0; vc < _vcs; ++vc ) {
+    for ( int i = 0; i < _count[vc]; ++i ) {
+      cp.Value( _flits[vc * _capacity + ((_head[vc] + i) & (_capacity - 1))] );
+    }
+  }
+  cp.Value( _state );
+  cp.Value( _out_port );
+  cp.Value( _out_vc );
+  cp.Value( _pri );
+  cp.Value( _expected_pid );
+  cp.Value( _watched );
+#ifdef TRACK_BUFFERS
+  cp.Value( _class_occupancy );
+#endif
+
+  // a route set is either the VC's own, the lookahead route set of one of 
+  // the VC's flits, or none; one left behind by a flit that has moved on 
+  // is restored as a copy
+  enum { route_set_none = -1, route_set_own = -2, route_set_copy = -3 };
+  if ( !_lookahead_routing ) {
+    cp.Value( _own_route_set );
+  } else if ( cp.Restoring( ) ) {
+    _own_route_set.resize( _vcs );
+  }
+  for ( int vc = 0; vc < _vcs; ++vc ) {
+    OutputSet * & rs = _route_set[vc];
+    int ref = route_set_none;
+    if ( !cp.Restoring( ) && rs ) {
+      ref = route_set_copy;
+      if ( !_own_route_set.empty( ) && ( rs == &_own_route_set[vc] ) ) {
+	ref = route_set_own;
+      }
+      for ( int i = 0; ( ref == route_set_copy ) && ( i < _count[vc] ); ++i ) {
+	if ( rs == &_Flit( vc, i )->cold( ).la_route_set ) {
+	  ref = i;
+	}
+      }
+    }
+    cp.Value( ref );
+    if ( ref == route_set_copy ) {
+      OutputSet copy;
+      if ( !cp.Restoring( ) ) {
+	copy = *rs;
+      }
+      cp.Value( copy );
+      if ( cp.Restoring( ) ) {
+	_own_route_set[vc] = copy;
+      }
+    }
+    if ( cp.Restoring( ) ) {
+      if ( ref == route_set_none ) {
+	rs = NULL;
+      } else if ( ( ref == route_set_own ) || ( ref == route_set_copy ) ) {
+	rs = &_own_route_set[vc];
+      } else if ( ref < _count[vc] ) {
+	rs = &_Flit( vc, ref )->cold( ).la_route_set;
+      } else {
+	cp.Error( "corrupt route set reference" );
+      }
+    }
+  }
+}
+
 void Buffer::Display( ostream & os ) const
 {
-  for(vector<VC*>::const_iterator i = _vc.begin(); i != _vc.end(); ++i) {
-    (*i)->Display(os);
+  for(int vc = 0; vc < _vcs; ++vc) {
+    if ( _state[vc] != VC::idle ) {
+      os << _VCName(vc) << ": "
+	 << " state: " << VC::VCSTATE[_state[vc]];
+      if(_state[vc] == VC::active) {
+	os << " out_port: " << _out_port[vc]
+	   << " out_vc: " << _out_vc[vc];
+      }
+      os << " fill: " << _count[vc];
+      if(_count[vc]) {
+	os << " front: " << FrontFlit(vc)->id;
+      }
+      os << " pri: " << _pri[vc];
+      os << endl;
+    }
   }
 }
@@ -41,12 +41,51 @@ class Buffer : public Module {
   int _occupancy;
   int _size;
 
-  vector<VC*> _vc;
+  int _vcs;
+
+  // Flits are stored in one contiguous array holding a ring buffer of 
+  // _capacity entries per VC; _capacity is a power of two that starts out 
+  // at vc_buf_size and is doubled if a buffer policy lets a VC grow beyond 
+  // it. The remaining per-VC state is kept as one array per field.
+  int _capacity;
+  vector<Flit *> _flits;
+  vector<int> _head;
+  vector<int> _count;
+
+  vector<VC::eVCState> _state;
+  vector<OutputSet *> _route_set;
+  vector<int> _out_port;
+  vector<int> _out_vc;
+  vector<int> _pri;
+  vector<int> _expected_pid;
+  vector<bool> _watched;
+
+  // route sets used when routing is not done by lookahead
+  vector<OutputSet> _own_route_set;
+
+  enum ePrioType { local_age_based, queue_length_based, hop_count_based, none, other };
+
+  ePrioType _pri_type;
+
+  int _priority_donation;
+
+  bool _lookahead_routing;
 
 #ifdef TRACK_BUFFERS
   vector<int> _class_occupancy;
 #endif
 
+  inline Flit * _Flit( int vc, int i ) const
+  {
+    return _flits[vc * _capacity + ((_head[vc] + i) & (_capacity - 1))];
+  }
+
+  void _Grow( );
+  void _UpdatePriority( int vc );
+  string _VCName( int vc ) const;
+
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   
   Buffer( const Configuration& config, int outputs,
@@ -55,25 +94,16 @@ public:
 
   void AddFlit( int vc, Flit *f );
 
-  inline Flit *RemoveFlit( int vc )
-  {
-    --_occupancy;
-#ifdef TRACK_BUFFERS
-    int cl = _vc[vc]->FrontFlit()->cl;
-    assert(_class_occupancy[cl] > 0);
-    --_class_occupancy[cl];
-#endif
-    return _vc[vc]->RemoveFlit( );
-  }
+  Flit *RemoveFlit( int vc );
   
   inline Flit *FrontFlit( int vc ) const
   {
-    return _vc[vc]->FrontFlit( );
+    return _count[vc] ? _flits[vc * _capacity + _head[vc]] : NULL;
   }
   
   inline bool Empty( int vc ) const
   {
-    return _vc[vc]->Empty( );
+    return !_count[vc];
   }
 
   inline bool Full( ) const
@@ -83,59 +113,61 @@ public:
 
   inline VC::eVCState GetState( int vc ) const
   {
-    return _vc[vc]->GetState( );
+    return _state[vc];
   }
 
-  inline void SetState( int vc, VC::eVCState s )
-  {
-    _vc[vc]->SetState(s);
-  }
+  void SetState( int vc, VC::eVCState s );
 
   inline const OutputSet *GetRouteSet( int vc ) const
   {
-    return _vc[vc]->GetRouteSet( );
+    return _route_set[vc];
   }
 
   inline void SetRouteSet( int vc, OutputSet * output_set )
   {
-    _vc[vc]->SetRouteSet(output_set);
+    _route_set[vc] = output_set;
+    _out_port[vc] = -1;
+    _out_vc[vc] = -1;
   }
 
   inline void SetOutput( int vc, int out_port, int out_vc )
   {
-    _vc[vc]->SetOutput(out_port, out_vc);
+    _out_port[vc] = out_port;
+    _out_vc[vc] = out_vc;
   }
 
   inline int GetOutputPort( int vc ) const
   {
-    return _vc[vc]->GetOutputPort( );
+    return _out_port[vc];
   }
 
   inline int GetOutputVC( int vc ) const
   {
-    return _vc[vc]->GetOutputVC( );
+    return _out_vc[vc];
   }
 
   inline int GetPriority( int vc ) const
   {
-    return _vc[vc]->GetPriority( );
+    return _pri[vc];
   }
 
   inline void Route( int vc, tRoutingFunction rf, const Router* router, const Flit* f, int in_channel )
   {
-    _vc[vc]->Route(rf, router, f, in_channel);
+    rf( router, f, in_channel, _route_set[vc], false );
+    _out_port[vc] = -1;
+    _out_vc[vc] = -1;
   }
 
   // ==== Debug functions ====
 
   inline void SetWatch( int vc, bool watch = true )
   {
-    _vc[vc]->SetWatch(watch);
+    _watched[vc] = watch;
   }
 
   inline bool IsWatched( int vc ) const
   {
-    return _vc[vc]->IsWatched( );
+    return _watched[vc];
   }
 
   inline int GetOccupancy( ) const
@@ -145,7 +177,7 @@ public:
 
   inline int GetOccupancy( int vc ) const
   {
-    return _vc[vc]->GetOccupancy( );
+    return _count[vc];
   }
 
 #ifdef TRACK_BUFFERS
@@ -41,10 +41,31 @@
 #include "buffer_state.hpp"
 #include "random_utils.hpp"
 #include "globals.hpp"
+#include "checkpoint.hpp"
 
 //#define DEBUG_FEEDBACK
 //#define DEBUG_SIMPLEFEEDBACK
 
+// Calls a policy method on the most derived policy class, which lets the 
+// compiler inline the policy code into the BufferState methods.
+#define POLICY_DISPATCH(call)						\
+  switch(_policy_type) {						\
+  case private_policy:							\
+    return static_cast<PrivateBufferPolicy *>(_buffer_policy)->call;	\
+  case shared_policy:							\
+    return static_cast<SharedBufferPolicy *>(_buffer_policy)->call;	\
+  case limited_policy:							\
+    return static_cast<LimitedSharedBufferPolicy *>(_buffer_policy)->call; \
+  case dynamic_policy:							\
+    return static_cast<DynamicLimitedSharedBufferPolicy *>(_buffer_policy)->call; \
+  case shifting_policy:							\
+    return static_cast<ShiftingDynamicLimitedSharedBufferPolicy *>(_buffer_policy)->call; \
+  case feedback_policy:							\
+    return static_cast<FeedbackSharedBufferPolicy *>(_buffer_policy)->call; \
+  case simplefeedback_policy:						\
+    return static_cast<SimpleFeedbackSharedBufferPolicy *>(_buffer_policy)->call; \
+  }
+
 BufferState::BufferPolicy::BufferPolicy(Configuration const & config, BufferState * parent, const string & name)
 : Module(parent, name), _buffer_state(parent)
 {
@@ -65,18 +86,25 @@ BufferState::BufferPolicy * BufferState::BufferPolicy::New(Configuration const &
   string buffer_policy = config.GetStr("buffer_policy");
   if(buffer_policy == "private") {
     sp = new PrivateBufferPolicy(config, parent, name);
+    parent->_policy_type = private_policy;
   } else if(buffer_policy == "shared") {
     sp = new SharedBufferPolicy(config, parent, name);
+    parent->_policy_type = shared_policy;
   } else if(buffer_policy == "limited") {
     sp = new LimitedSharedBufferPolicy(config, parent, name);
+    parent->_policy_type = limited_policy;
   } else if(buffer_policy == "dynamic") {
     sp = new DynamicLimitedSharedBufferPolicy(config, parent, name);
+    parent->_policy_type = dynamic_policy;
   } else if(buffer_policy == "shifting") {
     sp = new ShiftingDynamicLimitedSharedBufferPolicy(config, parent, name);
+    parent->_policy_type = shifting_policy;
   } else if(buffer_policy == "feedback") {
     sp = new FeedbackSharedBufferPolicy(config, parent, name);
+    parent->_policy_type = feedback_policy;
   } else if(buffer_policy == "simplefeedback") {
     sp = new SimpleFeedbackSharedBufferPolicy(config, parent, name);
+    parent->_policy_type = simplefeedback_policy;
   } else {
     cout << "Unknown buffer policy: " << buffer_policy << endl;
   }
@@ -261,6 +289,13 @@ int BufferState::SharedBufferPolicy::LimitFor(int vc) const
   return (_private_buf_size[i] + _shared_buf_size);
 }
 
+void BufferState::SharedBufferPolicy::_Serialize(Checkpoint & cp)
+{
+  cp.Value(_private_buf_occupancy);
+  cp.Value(_shared_buf_occupancy);
+  cp.Value(_reserved_slots);
+}
+
 BufferState::LimitedSharedBufferPolicy::LimitedSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : SharedBufferPolicy(config, parent, name), _active_vcs(0)
 {
@@ -307,6 +342,13 @@ int BufferState::LimitedSharedBufferPolicy::LimitFor(int vc) const
   return min(SharedBufferPolicy::LimitFor(vc), _max_held_slots);
 }
 
+void BufferState::LimitedSharedBufferPolicy::_Serialize(Checkpoint & cp)
+{
+  SharedBufferPolicy::_Serialize(cp);
+  cp.Value(_active_vcs);
+  cp.Value(_max_held_slots);
+}
+
 BufferState::DynamicLimitedSharedBufferPolicy::DynamicLimitedSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : LimitedSharedBufferPolicy(config, parent, name)
 {
@@ -489,6 +531,16 @@ int BufferState::FeedbackSharedBufferPolicy::LimitFor(int vc) const
   return min(SharedBufferPolicy::LimitFor(vc), _ComputeMaxSlots(vc));
 }
 
+void BufferState::FeedbackSharedBufferPolicy::_Serialize(Checkpoint & cp)
+{
+  SharedBufferPolicy::_Serialize(cp);
+  cp.Value(_occupancy_limit);
+  cp.Value(_round_trip_time);
+  cp.Value(_flit_sent_time);
+  cp.Value(_min_latency);
+  cp.Value(_total_mapped_size);
+}
+
 BufferState::SimpleFeedbackSharedBufferPolicy::SimpleFeedbackSharedBufferPolicy(Configuration const & config, BufferState * parent, const string & name)
   : FeedbackSharedBufferPolicy(config, parent, name)
 {
@@ -536,16 +588,33 @@ void BufferState::SimpleFeedbackSharedBufferPolicy::FreeSlotFor(int vc)
   SharedBufferPolicy::FreeSlotFor(vc);
 }
 
+void BufferState::SimpleFeedbackSharedBufferPolicy::_Serialize(Checkpoint & cp)
+{
+  FeedbackSharedBufferPolicy::_Serialize(cp);
+  cp.Value(_pending_credits);
+}
+
 BufferState::BufferState( const Configuration& config, Module *parent, const string& name ) : 
   Module( parent, name ), _occupancy(0)
 {
   _vcs = config.GetInt( "num_vcs" );
+  if(_vcs > Credit::max_vcs) {
+    ostringstream err;
+    err << "Number of VCs exceeds the maximum of " << Credit::max_vcs
+	<< " supported by credits";
+    Error(err.str());
+  }
   _size = config.GetInt("buf_size");
   if(_size < 0) {
     _size = _vcs * config.GetInt("vc_buf_size");
   }
 
   _buffer_policy = BufferPolicy::New(config, this, "policy");
+  _vc_buf_size = -1;
+  if(_policy_type == private_policy) {
+    _vc_buf_size = 
+      static_cast<PrivateBufferPolicy *>(_buffer_policy)->LimitFor();
+  }
 
   _wait_for_tail_credit = config.GetInt( "wait_for_tail_credit" );
 
@@ -569,14 +638,49 @@ BufferState::~BufferState()
   delete _buffer_policy;
 }
 
+void BufferState::SetMinLatency(int min_latency)
+{
+  POLICY_DISPATCH(SetMinLatency(min_latency));
+}
+
+bool BufferState::_IsFullFor(int vc) const
+{
+  POLICY_DISPATCH(IsFullFor(vc));
+  return true;
+}
+
+int BufferState::_AvailableFor(int vc) const
+{
+  POLICY_DISPATCH(AvailableFor(vc));
+  return 0;
+}
+
+int BufferState::_LimitFor(int vc) const
+{
+  POLICY_DISPATCH(LimitFor(vc));
+  return 0;
+}
+
+void BufferState::_TakeBuffer(int vc)
+{
+  POLICY_DISPATCH(TakeBuffer(vc));
+}
+
+void BufferState::_SendingFlit(Flit const * const f)
+{
+  POLICY_DISPATCH(SendingFlit(f));
+}
+
+void BufferState::_FreeSlotFor(int vc)
+{
+  POLICY_DISPATCH(FreeSlotFor(vc));
+}
+
 void BufferState::ProcessCredit( Credit const * const c )
 {
   assert( c );
 
-  set<int>::iterator iter = c->vc.begin();
-  while(iter != c->vc.end()) {
-
-    int const vc = *iter;
+  for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
 
     assert( ( vc >= 0 ) && ( vc < _vcs ) );
 
@@ -610,9 +714,7 @@ void BufferState::ProcessCredit( Credit const * const c )
     --_class_occupancy[cl];
 #endif
 
-    _buffer_policy->FreeSlotFor(vc);
-
-    ++iter;
+    _FreeSlotFor(vc);
   }
 }
 
@@ -630,7 +732,7 @@ void BufferState::SendingFlit( Flit const * const f )
 
   ++_vc_occupancy[vc];
   
-  _buffer_policy->SendingFlit(f);
+  _SendingFlit(f);
   
 #ifdef TRACK_BUFFERS
   _outstanding_classes[vc].push(f->cl);
@@ -660,7 +762,25 @@ void BufferState::TakeBuffer( int vc, int tag )
   }
   _in_use_by[vc] = tag;
   _tail_sent[vc] = false;
-  _buffer_policy->TakeBuffer(vc);
+  _TakeBuffer(vc);
+}
+
+// the buffer policy saves its own state as a child
+void BufferState::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "buffer size", _size );
+  cp.Check( "num_vcs", _vcs );
+  cp.Check( "buffer policy", _policy_type );
+  cp.Value( _occupancy );
+  cp.Value( _vc_occupancy );
+  cp.Value( _in_use_by );
+  cp.Value( _tail_sent );
+  cp.Value( _last_id );
+  cp.Value( _last_pid );
+#ifdef TRACK_BUFFERS
+  cp.Value( _outstanding_classes );
+  cp.Value( _class_occupancy );
+#endif
 }
 
 void BufferState::Display( ostream & os ) const
@@ -38,19 +38,23 @@
 
 class BufferState : public Module {
   
+  // The policies are not polymorphic: BufferState keeps the policy type in 
+  // _policy_type and calls the most derived class directly, so that the 
+  // checks on the common private-buffer path compile down to a compare.
+  enum ePolicyType { private_policy, shared_policy, limited_policy,
+		     dynamic_policy, shifting_policy, feedback_policy,
+		     simplefeedback_policy };
+
   class BufferPolicy : public Module {
   protected:
     BufferState const * const _buffer_state;
   public:
     BufferPolicy(Configuration const & config, BufferState * parent, 
 		 const string & name);
-    virtual void SetMinLatency(int min_latency) {}
-    virtual void TakeBuffer(int vc = 0);
-    virtual void SendingFlit(Flit const * const f);
-    virtual void FreeSlotFor(int vc = 0);
-    virtual bool IsFullFor(int vc = 0) const = 0;
-    virtual int AvailableFor(int vc = 0) const = 0;
-    virtual int LimitFor(int vc = 0) const = 0;
+    void SetMinLatency(int min_latency) {}
+    void TakeBuffer(int vc = 0);
+    void SendingFlit(Flit const * const f);
+    void FreeSlotFor(int vc = 0);
 
     static BufferPolicy * New(Configuration const & config, 
 			      BufferState * parent, const string & name);
@@ -62,10 +66,10 @@ class BufferState : public Module {
   public:
     PrivateBufferPolicy(Configuration const & config, BufferState * parent, 
 			const string & name);
-    virtual void SendingFlit(Flit const * const f);
-    virtual bool IsFullFor(int vc = 0) const;
-    virtual int AvailableFor(int vc = 0) const;
-    virtual int LimitFor(int vc = 0) const;
+    void SendingFlit(Flit const * const f);
+    bool IsFullFor(int vc = 0) const;
+    int AvailableFor(int vc = 0) const;
+    int LimitFor(int vc = 0) const;
   };
   
   class SharedBufferPolicy : public BufferPolicy {
@@ -78,14 +82,15 @@ class BufferState : public Module {
     int _shared_buf_occupancy;
     vector<int> _reserved_slots;
     void ProcessFreeSlot(int vc = 0);
+    virtual void _Serialize(Checkpoint & cp);
   public:
     SharedBufferPolicy(Configuration const & config, BufferState * parent, 
 		       const string & name);
-    virtual void SendingFlit(Flit const * const f);
-    virtual void FreeSlotFor(int vc = 0);
-    virtual bool IsFullFor(int vc = 0) const;
-    virtual int AvailableFor(int vc = 0) const;
-    virtual int LimitFor(int vc = 0) const;
+    void SendingFlit(Flit const * const f);
+    void FreeSlotFor(int vc = 0);
+    bool IsFullFor(int vc = 0) const;
+    int AvailableFor(int vc = 0) const;
+    int LimitFor(int vc = 0) const;
   };
 
   class LimitedSharedBufferPolicy : public SharedBufferPolicy {
@@ -93,15 +98,16 @@ class BufferState : public Module {
     int _vcs;
     int _active_vcs;
     int _max_held_slots;
+    virtual void _Serialize(Checkpoint & cp);
   public:
     LimitedSharedBufferPolicy(Configuration const & config, 
 			      BufferState * parent,
 			      const string & name);
-    virtual void TakeBuffer(int vc = 0);
-    virtual void SendingFlit(Flit const * const f);
-    virtual bool IsFullFor(int vc = 0) const;
-    virtual int AvailableFor(int vc = 0) const;
-    virtual int LimitFor(int vc = 0) const;
+    void TakeBuffer(int vc = 0);
+    void SendingFlit(Flit const * const f);
+    bool IsFullFor(int vc = 0) const;
+    int AvailableFor(int vc = 0) const;
+    int LimitFor(int vc = 0) const;
   };
     
   class DynamicLimitedSharedBufferPolicy : public LimitedSharedBufferPolicy {
@@ -109,8 +115,8 @@ class BufferState : public Module {
     DynamicLimitedSharedBufferPolicy(Configuration const & config, 
 				     BufferState * parent,
 				     const string & name);
-    virtual void TakeBuffer(int vc = 0);
-    virtual void SendingFlit(Flit const * const f);
+    void TakeBuffer(int vc = 0);
+    void SendingFlit(Flit const * const f);
   };
   
   class ShiftingDynamicLimitedSharedBufferPolicy : public DynamicLimitedSharedBufferPolicy {
@@ -118,8 +124,8 @@ class BufferState : public Module {
     ShiftingDynamicLimitedSharedBufferPolicy(Configuration const & config, 
 					     BufferState * parent,
 					     const string & name);
-    virtual void TakeBuffer(int vc = 0);
-    virtual void SendingFlit(Flit const * const f);
+    void TakeBuffer(int vc = 0);
+    void SendingFlit(Flit const * const f);
   };
   
   class FeedbackSharedBufferPolicy : public SharedBufferPolicy {
@@ -135,25 +141,27 @@ class BufferState : public Module {
     int _total_mapped_size;
     int _aging_scale;
     int _offset;
+    virtual void _Serialize(Checkpoint & cp);
   public:
     FeedbackSharedBufferPolicy(Configuration const & config, 
 			       BufferState * parent, const string & name);
-    virtual void SetMinLatency(int min_latency);
-    virtual void SendingFlit(Flit const * const f);
-    virtual void FreeSlotFor(int vc = 0);
-    virtual bool IsFullFor(int vc = 0) const;
-    virtual int AvailableFor(int vc = 0) const;
-    virtual int LimitFor(int vc = 0) const;
+    void SetMinLatency(int min_latency);
+    void SendingFlit(Flit const * const f);
+    void FreeSlotFor(int vc = 0);
+    bool IsFullFor(int vc = 0) const;
+    int AvailableFor(int vc = 0) const;
+    int LimitFor(int vc = 0) const;
   };
   
   class SimpleFeedbackSharedBufferPolicy : public FeedbackSharedBufferPolicy {
   protected:
     vector<int> _pending_credits;
+    virtual void _Serialize(Checkpoint & cp);
   public:
     SimpleFeedbackSharedBufferPolicy(Configuration const & config, 
 				     BufferState * parent, const string & name);
-    virtual void SendingFlit(Flit const * const f);
-    virtual void FreeSlotFor(int vc = 0);
+    void SendingFlit(Flit const * const f);
+    void FreeSlotFor(int vc = 0);
   };
   
   bool _wait_for_tail_credit;
@@ -162,13 +170,26 @@ class BufferState : public Module {
   vector<int> _vc_occupancy;
   int  _vcs;
   
+  ePolicyType _policy_type;
   BufferPolicy * _buffer_policy;
+
+  // per-VC buffer size for private buffers
+  int _vc_buf_size;
+
+  bool _IsFullFor( int vc ) const;
+  int _AvailableFor( int vc ) const;
+  int _LimitFor( int vc ) const;
+  void _TakeBuffer( int vc );
+  void _SendingFlit( Flit const * const f );
+  void _FreeSlotFor( int vc );
   
   vector<int> _in_use_by;
   vector<bool> _tail_sent;
   vector<int> _last_id;
   vector<int> _last_pid;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 #ifdef TRACK_BUFFERS
   int _classes;
   vector<queue<int> > _outstanding_classes;
@@ -182,9 +203,7 @@ public:
 
   ~BufferState();
 
-  inline void SetMinLatency(int min_latency) {
-    _buffer_policy->SetMinLatency(min_latency);
-  }
+  void SetMinLatency(int min_latency);
 
   void ProcessCredit( Credit const * const c );
   void SendingFlit( Flit const * const f );
@@ -196,13 +215,24 @@ public:
     return (_occupancy == _size);
   }
   inline bool IsFullFor( int vc = 0 ) const {
-    return _buffer_policy->IsFullFor(vc);
+    if(_policy_type == private_policy) {
+      assert((vc >= 0) && (vc < _vcs));
+      return (_vc_occupancy[vc] >= _vc_buf_size);
+    }
+    return _IsFullFor(vc);
   }
   inline int AvailableFor( int vc = 0 ) const {
-    return _buffer_policy->AvailableFor(vc);
+    if(_policy_type == private_policy) {
+      assert((vc >= 0) && (vc < _vcs));
+      return _vc_buf_size - _vc_occupancy[vc];
+    }
+    return _AvailableFor(vc);
   }
   inline int LimitFor( int vc = 0 ) const {
-    return _buffer_policy->LimitFor(vc);
+    if(_policy_type == private_policy) {
+      return _vc_buf_size;
+    }
+    return _LimitFor(vc);
   }
   inline bool IsEmptyFor(int vc = 0) const {
     assert((vc >= 0) && (vc < _vcs));
@@ -37,12 +37,13 @@
 #ifndef _CHANNEL_HPP
 #define _CHANNEL_HPP
 
-#include <queue>
+#include <vector>
 #include <cassert>
 
 #include "globals.hpp"
 #include "module.hpp"
 #include "timed_module.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -61,22 +62,36 @@ public:
   
   // Receive data
   virtual T * Receive(); 
+
+  // Module to wake up when data is delivered
+  void SetReceiver(TimedModule * receiver) { _receiver = receiver; }
   
   virtual void ReadInputs();
   virtual void Evaluate() {}
   virtual void WriteOutputs();
 
+  virtual bool Idle() const;
+  virtual int NextEventTime() const;
+
 protected:
   int _delay;
   T * _input;
   T * _output;
-  queue<pair<int, T *> > _wait_queue;
+  // items in transit; an item read in cycle t is delivered in cycle
+  // t + _delay - 1 and stored in slot (t + _delay - 1) % _delay, which no
+  // other item in transit can map to
+  vector<T *> _wait_slots;
+  int _in_transit;
+  TimedModule * _receiver;
+
+  virtual void _Serialize(Checkpoint & cp);
 
 };
 
 template<typename T>
 Channel<T>::Channel(Module * parent, string const & name)
-  : TimedModule(parent, name), _delay(1), _input(0), _output(0) {
+  : TimedModule(parent, name), _delay(1), _input(0), _output(0),
+    _wait_slots(1, 0), _in_transit(0), _receiver(0) {
 }
 
 template<typename T>
@@ -84,12 +99,17 @@ void Channel<T>::SetLatency(int cycles) {
   if(cycles <= 0) {
     Error("Channel must have positive delay.");
   }
+  assert(_in_transit == 0);
   _delay = cycles ;
+  _wait_slots.assign(_delay, 0);
 }
 
 template<typename T>
 void Channel<T>::Send(T * data) {
   _input = data;
+  if(data) {
+    Wake();
+  }
 }
 
 template<typename T>
@@ -100,7 +120,10 @@ T * Channel<T>::Receive() {
 template<typename T>
 void Channel<T>::ReadInputs() {
   if(_input) {
-    _wait_queue.push(make_pair(GetSimTime() + _delay - 1, _input));
+    T * & slot = _wait_slots[(GetSimTime() + _delay - 1) % _delay];
+    assert(!slot);
+    slot = _input;
+    ++_in_transit;
     _input = 0;
   }
 }
@@ -108,18 +131,51 @@ void Channel<T>::ReadInputs() {
 template<typename T>
 void Channel<T>::WriteOutputs() {
   _output = 0;
-  if(_wait_queue.empty()) {
+  if(_in_transit == 0) {
     return;
   }
-  pair<int, T *> const & item = _wait_queue.front();
-  int const & time = item.first;
-  if(GetSimTime() < time) {
+  T * & slot = _wait_slots[GetSimTime() % _delay];
+  if(!slot) {
     return;
   }
-  assert(GetSimTime() == time);
-  _output = item.second;
-  assert(_output);
-  _wait_queue.pop();
+  _output = slot;
+  slot = 0;
+  --_in_transit;
+  if(_receiver) {
+    _receiver->Wake();
+  }
+}
+
+template<typename T>
+bool Channel<T>::Idle() const {
+  return !_input && !_output && (_in_transit == 0);
+}
+
+template<typename T>
+int Channel<T>::NextEventTime() const {
+  if(_input || _output) {
+    return GetSimTime();
+  }
+  if(_in_transit == 0) {
+    return numeric_limits<int>::max();
+  }
+  int const time = GetSimTime();
+  for(int d = 0; d < _delay; ++d) {
+    if(_wait_slots[(time + d) % _delay]) {
+      return time + d;
+    }
+  }
+  assert(false);
+  return numeric_limits<int>::max();
+}
+
+template<typename T>
+void Channel<T>::_Serialize(Checkpoint & cp) {
+  cp.Check("channel delay", _delay);
+  cp.Value(_input);
+  cp.Value(_output);
+  cp.Value(_wait_slots);
+  cp.Value(_in_transit);
 }
 
 #endif
@@ -0,0 +1,294 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*checkpoint.cpp
+ *
+ *The file starts with a signature and a format version, followed by the 
+ *state in the order it is visited. Values are stored in the byte order 
+ *and size of the host, so checkpoints are not portable between machines 
+ *of different architectures.
+ *
+ */
+
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+
+#include "booksim.hpp"
+#include "checkpoint.hpp"
+#include "flit.hpp"
+#include "credit.hpp"
+#include "outputset.hpp"
+#include "packet_reply_info.hpp"
+
+static char const _signature[] = "BookSim checkpoint";
+static int const _version = 1;
+
+Checkpoint::Checkpoint( string const & filename, bool restoring )
+  : _filename( filename ), _restoring( restoring ), _file( _file_stream )
+{
+  _file_stream.open( filename.c_str( ), 
+		     ( restoring ? ios::in : ios::out ) | ios::binary );
+  if ( !_file ) {
+    Error( restoring ? "could not open file for reading" : 
+	   "could not open file for writing" );
+  }
+  _Header( );
+}
+
+Checkpoint::Checkpoint( stringstream & buffer, bool restoring )
+  : _filename( "in memory" ), _restoring( restoring ), _file( buffer )
+{
+  if ( restoring ) {
+    buffer.clear( );
+    buffer.seekg( 0 );
+  }
+  _Header( );
+}
+
+void Checkpoint::_Header( )
+{
+  char signature[sizeof( _signature )];
+  memcpy( signature, _signature, sizeof( _signature ) );
+  _Bytes( signature, sizeof( signature ) );
+  if ( memcmp( signature, _signature, sizeof( _signature ) ) ) {
+    Error( "not a checkpoint file" );
+  }
+  int version = _version;
+  Value( version );
+  if ( version != _version ) {
+    ostringstream msg;
+    msg << "unsupported format version " << version;
+    Error( msg.str( ) );
+  }
+#ifdef TRACK_FLIT_IDS
+  Check( "flit id tracking", 1 );
+#else
+  Check( "flit id tracking", 0 );
+#endif
+}
+
+Checkpoint::~Checkpoint( )
+{
+  if ( !_restoring ) {
+    _file.flush( );
+    if ( !_file ) {
+      Error( "write failed" );
+    }
+  }
+}
+
+void Checkpoint::Error( string const & msg ) const
+{
+  cout << "Error in checkpoint " << _filename << " : " << msg << endl;
+  exit( -1 );
+}
+
+void Checkpoint::_Bytes( void * data, size_t size )
+{
+  if ( _restoring ) {
+    _file.read( (char *)data, size );
+    if ( !_file ) {
+      Error( "unexpected end of file" );
+    }
+  } else {
+    _file.write( (char const *)data, size );
+  }
+}
+
+int Checkpoint::Size( int size )
+{
+  Value( size );
+  if ( size < 0 ) {
+    Error( "corrupt container size" );
+  }
+  return size;
+}
+
+void Checkpoint::Section( string const & name )
+{
+  string found = name;
+  Value( found );
+  if ( found != name ) {
+    Error( "found state of " + found + " where " + name + " was expected;"
+	   " the checkpoint was taken with a different configuration" );
+  }
+}
+
+void Checkpoint::Check( string const & name, int value )
+{
+  int found = value;
+  Value( found );
+  if ( found != value ) {
+    ostringstream msg;
+    msg << "taken with " << name << " = " << found << ", but it is " << value
+	<< " here";
+    Error( msg.str( ) );
+  }
+}
+
+void Checkpoint::Value( string & s )
+{
+  s.resize( Size( s.size( ) ) );
+  if ( !s.empty( ) ) {
+    _Bytes( &s[0], s.size( ) );
+  }
+}
+
+void Checkpoint::Value( vector<bool> & v )
+{
+  v.resize( Size( v.size( ) ) );
+  for ( size_t i = 0; i < v.size( ); ++i ) {
+    bool b = v[i];
+    Value( b );
+    v[i] = b;
+  }
+}
+
+void Checkpoint::Value( OutputSet & s )
+{
+  // the elements are kept in priority order, so adding them back in that 
+  // order rebuilds the same set
+  vector<OutputSet::sSetElement> elements;
+  if ( !_restoring ) {
+    OutputSet::ElementList const & l = s.GetSet( );
+    elements.assign( l.begin( ), l.end( ) );
+  }
+  Value( elements );
+  if ( _restoring ) {
+    s.Clear( );
+    for ( size_t i = 0; i < elements.size( ); ++i ) {
+      OutputSet::sSetElement const & e = elements[i];
+      s.AddRange( e.output_port, e.vc_start, e.vc_end, e.pri );
+    }
+  }
+}
+
+void Checkpoint::Value( Flit * & f )
+{
+  // -1 for none, the index of a flit saved before, or the number of flits
+  // saved so far if the flit itself follows
+  int index = -1;
+  bool saved = false;
+  if ( !_restoring && f ) {
+    map<Flit const *, int>::const_iterator iter = _flit_index.find( f );
+    if ( iter != _flit_index.end( ) ) {
+      index = iter->second;
+      saved = true;
+    } else {
+      index = _flit_index.size( );
+      _flit_index[f] = index;
+    }
+  }
+  Value( index );
+  if ( index < 0 ) {
+    f = NULL;
+    return;
+  }
+  if ( _restoring ) {
+    if ( index < (int)_flits.size( ) ) {
+      f = _flits[index];
+      return;
+    }
+    if ( index > (int)_flits.size( ) ) {
+      Error( "corrupt flit reference" );
+    }
+    f = Flit::New( );
+    _flits.push_back( f );
+  } else if ( saved ) {
+    return;
+  }
+  Value( f->type );
+  Value( f->vc );
+  Value( f->cl );
+  Value( f->head );
+  Value( f->tail );
+  Value( f->record );
+  Value( f->watch );
+  Value( f->id );
+  Value( f->pid );
+  Value( f->src );
+  Value( f->dest );
+  Value( f->pri );
+  Value( f->hops );
+  Value( f->subnetwork );
+  Value( f->intm );
+  Value( f->ph );
+  Flit::sColdFields & c = f->cold( );
+  Value( c.ctime );
+  Value( c.itime );
+  Value( c.atime );
+  if ( c.data ) {
+    Error( "flits carrying data cannot be checkpointed" );
+  }
+  Value( c.la_route_set );
+}
+
+void Checkpoint::Value( Credit * & c )
+{
+  bool present = ( c != NULL );
+  Value( present );
+  if ( !present ) {
+    c = NULL;
+    return;
+  }
+  vector<int> vcs;
+  if ( _restoring ) {
+    c = Credit::New( );
+  } else {
+    for ( int vc = c->FirstVC( ); vc >= 0; vc = c->NextVC( vc ) ) {
+      vcs.push_back( vc );
+    }
+  }
+  Value( vcs );
+  if ( _restoring ) {
+    for ( size_t i = 0; i < vcs.size( ); ++i ) {
+      c->AddVC( vcs[i] );
+    }
+  }
+  Value( c->head );
+  Value( c->tail );
+  Value( c->id );
+}
+
+void Checkpoint::Value( PacketReplyInfo * & r )
+{
+  bool present = ( r != NULL );
+  Value( present );
+  if ( !present ) {
+    r = NULL;
+    return;
+  }
+  if ( _restoring ) {
+    r = PacketReplyInfo::New( );
+  }
+  Value( r->source );
+  Value( r->time );
+  Value( r->record );
+  Value( r->type );
+}
@@ -0,0 +1,214 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _CHECKPOINT_HPP_
+#define _CHECKPOINT_HPP_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <list>
+#include <queue>
+#include <set>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+
+#include "id_slab.hpp"
+
+using namespace std;
+
+class Flit;
+class Credit;
+class PacketReplyInfo;
+class OutputSet;
+
+// A binary snapshot of a simulation, written or read back by walking the 
+// simulator's state in the same order either way: every stateful piece 
+// passes its members to Value(), which writes them to the file when 
+// saving and overwrites them with the file's contents when restoring. 
+// Containers are rebuilt with the saved number of elements. Flits are 
+// saved in full the first time they are reached and by reference after 
+// that; credits and reply records have a single owner each.
+//
+// The file records the values that depend on the configuration only as 
+// far as needed to recognize a mismatch (see Section() and Check()), so 
+// a checkpoint can only be restored into a simulator built from the same 
+// network, router and traffic parameters.
+class Checkpoint {
+
+  string _filename;
+  bool _restoring;
+  fstream _file_stream;
+  iostream & _file;
+
+  map<Flit const *, int> _flit_index;
+  vector<Flit *> _flits;
+
+  void _Bytes( void * data, size_t size );
+  void _Header( );
+
+public:
+
+  Checkpoint( string const & filename, bool restoring );
+
+  // a snapshot kept in memory, e.g. to return to the same state several
+  // times; restoring always starts from the beginning of the buffer
+  Checkpoint( stringstream & buffer, bool restoring );
+  ~Checkpoint( );
+
+  inline bool Restoring( ) const { return _restoring; }
+
+  void Error( string const & msg ) const;
+
+  // marks the start of a named part of the state; restoring fails if the
+  // file holds a different part at this point
+  void Section( string const & name );
+
+  // a configuration-derived value that must be the same in the restoring 
+  // simulator
+  void Check( string const & name, int value );
+
+  void Value( string & s );
+  void Value( vector<bool> & v );
+  void Value( OutputSet & s );
+  void Value( Flit * & f );
+  void Value( Credit * & c );
+  void Value( PacketReplyInfo * & r );
+
+  template<class T> void Value( T & v );
+  template<class A, class B> void Value( pair<A, B> & p );
+  template<class T> void Value( vector<T> & v );
+  template<class T> void Value( deque<T> & d );
+  template<class T> void Value( list<T> & l );
+  template<class T> void Value( queue<T> & q );
+  template<class T, class C, class O> void Value( priority_queue<T, C, O> & q );
+  template<class T> void Value( set<T> & s );
+  template<class K, class V> void Value( map<K, V> & m );
+  template<class T> void Value( IdSlab<T> & s );
+
+  // the number of elements of a container that is saved element by element
+  int Size( int size );
+};
+
+template<class T> void Checkpoint::Value( T & v )
+{
+  static_assert( is_trivially_copyable<T>::value && !is_pointer<T>::value,
+		 "only plain values can be checkpointed directly" );
+  _Bytes( &v, sizeof( T ) );
+}
+
+template<class A, class B> void Checkpoint::Value( pair<A, B> & p )
+{
+  Value( p.first );
+  Value( p.second );
+}
+
+template<class T> void Checkpoint::Value( vector<T> & v )
+{
+  v.resize( Size( v.size( ) ) );
+  for ( size_t i = 0; i < v.size( ); ++i ) {
+    Value( v[i] );
+  }
+}
+
+template<class T> void Checkpoint::Value( deque<T> & d )
+{
+  d.resize( Size( d.size( ) ) );
+  for ( size_t i = 0; i < d.size( ); ++i ) {
+    Value( d[i] );
+  }
+}
+
+template<class T> void Checkpoint::Value( list<T> & l )
+{
+  l.resize( Size( l.size( ) ) );
+  for ( typename list<T>::iterator i = l.begin( ); i != l.end( ); ++i ) {
+    Value( *i );
+  }
+}
+
+template<class T> void Checkpoint::Value( queue<T> & q )
+{
+  deque<T> d;
+  if ( !_restoring ) {
+    for ( queue<T> c = q; !c.empty( ); c.pop( ) ) {
+      d.push_back( c.front( ) );
+    }
+  }
+  Value( d );
+  if ( _restoring ) {
+    q = queue<T>( d );
+  }
+}
+
+template<class T, class C, class O> 
+void Checkpoint::Value( priority_queue<T, C, O> & q )
+{
+  // saved in the order the elements come out
+  vector<T> v;
+  if ( !_restoring ) {
+    for ( priority_queue<T, C, O> c = q; !c.empty( ); c.pop( ) ) {
+      v.push_back( c.top( ) );
+    }
+  }
+  Value( v );
+  if ( _restoring ) {
+    q = priority_queue<T, C, O>( );
+    for ( size_t i = 0; i < v.size( ); ++i ) {
+      q.push( v[i] );
+    }
+  }
+}
+
+template<class T> void Checkpoint::Value( set<T> & s )
+{
+  vector<T> v( s.begin( ), s.end( ) );
+  Value( v );
+  if ( _restoring ) {
+    s = set<T>( v.begin( ), v.end( ) );
+  }
+}
+
+template<class K, class V> void Checkpoint::Value( map<K, V> & m )
+{
+  vector<pair<K, V> > v( m.begin( ), m.end( ) );
+  Value( v );
+  if ( _restoring ) {
+    m = map<K, V>( v.begin( ), v.end( ) );
+  }
+}
+
+template<class T> void Checkpoint::Value( IdSlab<T> & s )
+{
+  Value( s._slots );
+  Value( s._base );
+  Value( s._size );
+}
+
+#endif
@@ -147,6 +147,7 @@ vector<double> Configuration::GetFloatArray(string const & field) const
 
 void Configuration::ParseFile(string const & filename)
 {
+  theConfig = this;
   if((_config_file = fopen(filename.c_str(), "r")) == 0) {
     cerr << "Could not open configuration file " << filename << endl;
     exit(-1);
@@ -160,6 +161,7 @@ void Configuration::ParseFile(string const & filename)
 
 void Configuration::ParseString(string const & str)
 {
+  theConfig = this;
   _config_string = str + ';';
   yyparse();
   _config_string = "";
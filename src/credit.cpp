@@ -30,50 +30,90 @@
  *A class for credits
  */
 
+#include <mutex>
+
 #include "booksim.hpp"
 #include "credit.hpp"
 
-stack<Credit *> Credit::_all;
-stack<Credit *> Credit::_free;
+thread_local Credit::sPool * Credit::_pool = NULL;
+
+// number of credits allocated at once whenever the free list runs dry
+static const int _chunk_size = 1024;
 
 Credit::Credit()
+  : _vc_words(max_vcs / 64)
 {
   Reset();
 }
 
 void Credit::Reset()
 {
-  vc.clear();
+  for(int w = 0; w < _vc_words; ++w) {
+    _vc_bits[w] = 0;
+  }
+  _vc_words = 0;
   head = false;
   tail = false;
   id   = -1;
 }
 
+Credit::sPool * Credit::_Pool() {
+  if(!_pool) {
+    _pool = new sPool;
+  }
+  return _pool;
+}
+
+// routers allocate and free credits while being evaluated, which may happen
+// concurrently when the network kernel runs on multiple threads
 Credit * Credit::New() {
-  Credit * c;
-  if(_free.empty()) {
-    c = new Credit();
-    _all.push(c);
-  } else {
-    c = _free.top();
-    c->Reset();
-    _free.pop();
+  sPool * const p = _Pool();
+  unique_lock<mutex> guard(p->lock, defer_lock);
+  if(p->shared) {
+    guard.lock();
+  }
+  if(p->free.empty()) {
+    Credit * const chunk = new Credit[_chunk_size];
+    p->chunks.push_back(chunk);
+    p->allocated += _chunk_size;
+    for(int i = _chunk_size - 1; i >= 0; --i) {
+      p->free.push_back(&chunk[i]);
+    }
   }
+  Credit * const c = p->free.back();
+  c->Reset();
+  p->free.pop_back();
   return c;
 }
 
 void Credit::Free() {
-  _free.push(this);
+  sPool * const p = _Pool();
+  unique_lock<mutex> guard(p->lock, defer_lock);
+  if(p->shared) {
+    guard.lock();
+  }
+  p->free.push_back(this);
 }
 
 void Credit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  sPool * const p = _Pool();
+  for(size_t i = 0; i < p->chunks.size(); ++i) {
+    delete [] p->chunks[i];
   }
+  p->chunks.clear();
+  p->free.clear();
+  p->allocated = 0;
 }
 
+int Credit::NumVCs() const {
+  int n = 0;
+  for(int w = 0; w < _vc_words; ++w) {
+    n += __builtin_popcountll(_vc_bits[w]);
+  }
+  return n;
+}
 
 int Credit::OutStanding(){
-  return _all.size()-_free.size();
+  sPool * const p = _Pool();
+  return p->allocated - p->free.size();
 }
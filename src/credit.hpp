@@ -28,14 +28,38 @@
 #ifndef _CREDIT_HPP_
 #define _CREDIT_HPP_
 
-#include <set>
-#include <stack>
+#include <vector>
+#include <mutex>
+#include <cassert>
 
 class Credit {
 
 public:
 
-  set<int> vc;
+  // upper bound on the number of VCs a credit can refer to
+  static const int max_vcs = 256;
+
+  // the VCs a credit returns buffer slots for are kept as a bitmask; iterate
+  // them in ascending order via
+  //   for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc))
+  inline void AddVC(int vc) {
+    assert((vc >= 0) && (vc < max_vcs));
+    int const w = vc >> 6;
+    _vc_bits[w] |= 1ULL << (vc & 63);
+    if(w >= _vc_words) {
+      _vc_words = w + 1;
+    }
+  }
+  inline bool HasVCs() const {
+    return (_vc_words > 0);
+  }
+  int NumVCs() const;
+  inline int FirstVC() const {
+    return _FindVC(0);
+  }
+  inline int NextVC(int vc) const {
+    return _FindVC(vc + 1);
+  }
 
   // these are only used by the event router
   bool head, tail;
@@ -49,8 +73,40 @@ public:
   static int OutStanding();
 private:
 
-  static stack<Credit *> _all;
-  static stack<Credit *> _free;
+  unsigned long long _vc_bits[max_vcs / 64];
+  int _vc_words;
+
+  inline int _FindVC(int start) const {
+    int w = start >> 6;
+    if(w >= _vc_words) {
+      return -1;
+    }
+    unsigned long long bits = _vc_bits[w] & (~0ULL << (start & 63));
+    while(!bits) {
+      if(++w >= _vc_words) {
+	return -1;
+      }
+      bits = _vc_bits[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+  }
+
+  // credits are carved out of contiguous chunks and recycled through a free
+  // list rather than being allocated individually; every simulation has 
+  // its own pool, which its helper threads share (see sim_context.hpp), and
+  // which is only locked once it has been shared
+  struct sPool {
+    vector<Credit *> chunks;
+    vector<Credit *> free;
+    int allocated;
+    bool shared;
+    mutex lock;
+    sPool() : allocated(0), shared(false) {}
+  };
+  static thread_local sPool * _pool;
+  static sPool * _Pool();
+
+  friend class SimContext;
 
   Credit();
   ~Credit() {}
@@ -37,8 +37,7 @@
 #include "booksim.hpp"
 #include "flit.hpp"
 
-stack<Flit *> Flit::_all;
-stack<Flit *> Flit::_free;
+thread_local Flit::sPool * Flit::_pool = NULL;
 
 ostream& operator<<( ostream& os, const Flit& f )
 {
@@ -48,14 +47,13 @@ ostream& operator<<( ostream& os, const Flit& f )
      << " Head: " << f.head
      << " Tail: " << f.tail << endl;
   os << "  Source: " << f.src << "  Dest: " << f.dest << " Intm: "<<f.intm<<endl;
-  os << "  Creation time: " << f.ctime << " Injection time: " << f.itime << " Arrival time: " << f.atime << " Phase: "<<f.ph<< endl;
+  os << "  Creation time: " << f.cold().ctime << " Injection time: " << f.cold().itime << " Arrival time: " << f.cold().atime << " Phase: "<<f.ph<< endl;
   os << "  VC: " << f.vc << endl;
   return os;
 }
 
 Flit::Flit() 
 {  
-  Reset();
 }  
 
 void Flit::Reset() 
@@ -65,9 +63,6 @@ void Flit::Reset()
   cl        = -1 ;
   head      = false ;
   tail      = false ;
-  ctime     = -1 ;
-  itime     = -1 ;
-  atime     = -1 ;
   id        = -1 ;
   pid       = -1 ;
   hops      = 0 ;
@@ -79,29 +74,51 @@ void Flit::Reset()
   pri = 0;
   intm =-1;
   ph = -1;
-  data = 0;
+
+  sColdFields & c = cold();
+  c.ctime   = -1 ;
+  c.itime   = -1 ;
+  c.atime   = -1 ;
+  c.data    = 0 ;
+  c.la_route_set.Clear();
 }  
 
+Flit::sPool * Flit::_Pool() {
+  if(!_pool) {
+    _pool = new sPool;
+  }
+  return _pool;
+}
+
 Flit * Flit::New() {
-  Flit * f;
-  if(_free.empty()) {
-    f = new Flit;
-    _all.push(f);
-  } else {
-    f = _free.top();
-    f->Reset();
-    _free.pop();
+  sPool * const p = _Pool();
+  if(p->free.empty()) {
+    int const base = p->chunks.size() * _chunk_size;
+    Flit * const chunk = new Flit[_chunk_size];
+    p->chunks.push_back(chunk);
+    p->cold_chunks.push_back(new sColdFields[_chunk_size]);
+    for(int i = _chunk_size - 1; i >= 0; --i) {
+      chunk[i]._index = base + i;
+      p->free.push_back(&chunk[i]);
+    }
   }
+  Flit * const f = p->free.back();
+  f->Reset();
+  p->free.pop_back();
   return f;
 }
 
 void Flit::Free() {
-  _free.push(this);
+  _pool->free.push_back(this);
 }
 
 void Flit::FreeAll() {
-  while(!_all.empty()) {
-    delete _all.top();
-    _all.pop();
+  sPool * const p = _Pool();
+  for(size_t i = 0; i < p->chunks.size(); ++i) {
+    delete [] p->chunks[i];
+    delete [] p->cold_chunks[i];
   }
+  p->chunks.clear();
+  p->cold_chunks.clear();
+  p->free.clear();
 }
@@ -29,12 +29,12 @@
 #define _FLIT_HPP_
 
 #include <iostream>
-#include <stack>
+#include <vector>
 
 #include "booksim.hpp"
 #include "outputset.hpp"
 
-class Flit {
+class alignas(64) Flit {
 
 public:
 
@@ -44,6 +44,24 @@ public:
 		  WRITE_REQUEST = 2,
 		  WRITE_REPLY   = 3,
                   ANY_TYPE      = 4 };
+
+  // Fields that are rarely touched while a flit traverses the network; 
+  // these are kept in a side array so that the remaining fields, which
+  // routers read at every hop, fit in a single cache line
+  struct sColdFields {
+
+    int  ctime;
+    int  itime;
+    int  atime;
+
+    // Fields for arbitrary data
+    void* data;
+
+    // Lookahead route info
+    OutputSet la_route_set;
+
+  };
+
   FlitType type;
 
   int vc;
@@ -52,23 +70,18 @@ public:
 
   bool head;
   bool tail;
-  
-  int  ctime;
-  int  itime;
-  int  atime;
+  bool record;
+  bool watch;
 
   int  id;
   int  pid;
 
-  bool record;
-
   int  src;
   int  dest;
 
   int  pri;
 
   int  hops;
-  bool watch;
   int  subnetwork;
   
   // intermediate destination (if any)
@@ -77,11 +90,18 @@ public:
   // phase in multi-phase algorithms
   mutable int ph;
 
-  // Fields for arbitrary data
-  void* data ;
+  inline sColdFields & cold() {
+    return _pool->cold_chunks[_index / _chunk_size][_index % _chunk_size];
+  }
+  inline sColdFields const & cold() const {
+    return _pool->cold_chunks[_index / _chunk_size][_index % _chunk_size];
+  }
 
-  // Lookahead route info
-  OutputSet la_route_set;
+  // position of the flit in the slab it was allocated from; stable for 
+  // the lifetime of the simulation
+  inline int Index() const {
+    return _index;
+  }
 
   void Reset();
 
@@ -91,11 +111,25 @@ public:
 
 private:
 
+  int _index;
+
   Flit();
   ~Flit() {}
 
-  static stack<Flit *> _all;
-  static stack<Flit *> _free;
+  // flits are allocated in chunks of _chunk_size, each paired with a 
+  // chunk of cold fields, and recycled through a free list; every 
+  // simulation has its own pool (see sim_context.hpp)
+  static const int _chunk_size = 1024;
+
+  struct sPool {
+    vector<Flit *> chunks;
+    vector<sColdFields *> cold_chunks;
+    vector<Flit *> free;
+  };
+  static thread_local sPool * _pool;
+  static sPool * _Pool();
+
+  friend class SimContext;
 
 };
 
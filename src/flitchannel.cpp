@@ -89,3 +89,9 @@ void FlitChannel::WriteOutputs() {
 	       << "." << endl;
   }
 }
+
+void FlitChannel::_Serialize(Checkpoint & cp) {
+  cp.Value(_active);
+  cp.Value(_idle);
+  Channel<Flit>::_Serialize(cp);
+}
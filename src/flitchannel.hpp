@@ -94,6 +94,8 @@ private:
   // Statistics for Activity Factors
   vector<int> _active;
   int _idle;
+
+  virtual void _Serialize(Checkpoint & cp);
 };
 
 #endif
@@ -0,0 +1,102 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef _ID_SLAB_HPP_
+#define _ID_SLAB_HPP_
+
+#include <deque>
+#include <cassert>
+
+// Maps flit or packet IDs to values, with T() marking unused IDs. IDs are
+// handed out consecutively, so the IDs that are live at any time span a
+// narrow window; the slab keeps one slot per ID in that window and shrinks
+// it from both ends as entries are erased, making insertion, lookup and
+// removal constant time.
+template<class T> class IdSlab {
+  deque<T> _slots;
+  int _base;
+  int _size;
+
+  friend class Checkpoint;
+
+public:
+  IdSlab( ) : _base( 0 ), _size( 0 ) { }
+
+  void Insert( int id, T val );
+  T    Find( int id ) const;
+  T    Erase( int id );
+
+  inline int  Size( ) const { return _size; }
+  inline bool Empty( ) const { return _size == 0; }
+
+  // live IDs are those in [Begin(), End()) for which Find() is not T()
+  inline int Begin( ) const { return _base; }
+  inline int End( ) const { return _base + _slots.size( ); }
+};
+
+template<class T> void IdSlab<T>::Insert( int id, T val )
+{
+  assert( val != T( ) );
+  if ( _slots.empty( ) ) {
+    _base = id;
+  }
+  while ( id < _base ) {
+    _slots.push_front( T( ) );
+    --_base;
+  }
+  while ( id >= End( ) ) {
+    _slots.push_back( T( ) );
+  }
+  assert( _slots[id - _base] == T( ) );
+  _slots[id - _base] = val;
+  ++_size;
+}
+
+template<class T> T IdSlab<T>::Find( int id ) const
+{
+  if ( ( id < _base ) || ( id >= End( ) ) ) {
+    return T( );
+  }
+  return _slots[id - _base];
+}
+
+template<class T> T IdSlab<T>::Erase( int id )
+{
+  T const val = Find( id );
+  assert( val != T( ) );
+  _slots[id - _base] = T( );
+  --_size;
+  while ( !_slots.empty( ) && ( _slots.front( ) == T( ) ) ) {
+    _slots.pop_front( );
+    ++_base;
+  }
+  while ( !_slots.empty( ) && ( _slots.back( ) == T( ) ) ) {
+    _slots.pop_back( );
+  }
+  return val;
+}
+
+#endif
@@ -29,8 +29,10 @@
 #include <vector>
 #include <cassert>
 #include <limits>
+#include <cmath>
 #include "random_utils.hpp"
 #include "injection.hpp"
+#include "checkpoint.hpp"
 
 using namespace std;
 
@@ -53,6 +55,38 @@ void InjectionProcess::reset()
 
 }
 
+void InjectionProcess::Serialize(Checkpoint & cp)
+{
+
+}
+
+int InjectionProcess::skip(int source)
+{
+  if(_rate <= 0.0) {
+    return numeric_limits<int>::max();
+  }
+  int cycles = 0;
+  while(!test(source)) {
+    ++cycles;
+  }
+  return cycles;
+}
+
+// number of failed trials before the first success in a sequence of
+// Bernoulli trials with success probability p
+static int geometric(double p)
+{
+  if(p >= 1.0) {
+    return 0;
+  }
+  if(p <= 0.0) {
+    return numeric_limits<int>::max();
+  }
+  double const u = 1.0 - RandomFloat();
+  double const k = floor(log(u) / log1p(-p));
+  return (k < (double)numeric_limits<int>::max()) ? (int)k : numeric_limits<int>::max();
+}
+
 InjectionProcess * InjectionProcess::New(string const & inject, int nodes, 
 					 double load, 
 					 Configuration const * const config)
@@ -146,6 +180,12 @@ bool BernoulliInjectionProcess::test(int source)
   return (RandomFloat() < _rate);
 }
 
+int BernoulliInjectionProcess::skip(int source)
+{
+  assert((source >= 0) && (source < _nodes));
+  return geometric(_rate);
+}
+
 //=============================================================
 
 OnOffInjectionProcess::OnOffInjectionProcess(int nodes, double rate, 
@@ -177,6 +217,11 @@ void OnOffInjectionProcess::reset()
   _state = _initial;
 }
 
+void OnOffInjectionProcess::Serialize(Checkpoint & cp)
+{
+  cp.Value(_state);
+}
+
 bool OnOffInjectionProcess::test(int source)
 {
   assert((source >= 0) && (source < _nodes));
@@ -188,3 +233,33 @@ bool OnOffInjectionProcess::test(int source)
   // generate packet
   return _state[source] && (RandomFloat() < _r1);
 }
+
+int OnOffInjectionProcess::skip(int source)
+{
+  assert((source >= 0) && (source < _nodes));
+
+  // in the on state, each cycle either ends the burst, injects a packet, or
+  // neither; only the first two change anything
+  double const p_event = _beta + (1.0 - _beta) * _r1;
+
+  int cycles = 0;
+  while(true) {
+    int const wait = geometric(_state[source] ? p_event : _alpha);
+    if(wait >= numeric_limits<int>::max() - cycles) {
+      return numeric_limits<int>::max();
+    }
+    cycles += wait;
+    if(!_state[source]) {
+      // turn on, then possibly inject in the same cycle
+      _state[source] = 1;
+      if(RandomFloat() < _r1) {
+	return cycles;
+      }
+    } else if(RandomFloat() * p_event < _beta) {
+      _state[source] = 0;
+    } else {
+      return cycles;
+    }
+    ++cycles;
+  }
+}
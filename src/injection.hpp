@@ -32,6 +32,8 @@
 
 using namespace std;
 
+class Checkpoint;
+
 class InjectionProcess {
 protected:
   int _nodes;
@@ -40,7 +42,13 @@ protected:
 public:
   virtual ~InjectionProcess() {}
   virtual bool test(int source) = 0;
+  // number of cycles before the source next injects a packet (or
+  // numeric_limits<int>::max() if it never will); the default simply calls
+  // test() until it succeeds
+  virtual int skip(int source);
   virtual void reset();
+  // saves or restores the state kept between calls
+  virtual void Serialize(Checkpoint & cp);
   static InjectionProcess * New(string const & inject, int nodes, double load, 
 				Configuration const * const config = NULL);
 };
@@ -49,6 +57,7 @@ class BernoulliInjectionProcess : public InjectionProcess {
 public:
   BernoulliInjectionProcess(int nodes, double rate);
   virtual bool test(int source);
+  virtual int skip(int source);
 };
 
 class OnOffInjectionProcess : public InjectionProcess {
@@ -62,7 +71,9 @@ public:
   OnOffInjectionProcess(int nodes, double rate, double alpha, double beta, 
 			double r1, vector<int> initial);
   virtual void reset();
+  virtual void Serialize(Checkpoint & cp);
   virtual bool test(int source);
+  virtual int skip(int source);
 };
 
 #endif 
@@ -40,6 +40,11 @@
 #include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
 
 
 
@@ -61,7 +66,7 @@
 //////////////////////
 
  /* the current traffic manager instance */
-TrafficManager * trafficManager = NULL;
+thread_local TrafficManager * trafficManager = NULL;
 
 int GetSimTime() {
   return trafficManager->getTime();
@@ -77,18 +82,18 @@ Stats * GetStats(const std::string & name) {
 }
 
 /* printing activity factor*/
-bool gPrintActivity;
+thread_local bool gPrintActivity;
 
-int gK;//radix
-int gN;//dimension
-int gC;//concentration
+thread_local int gK;//radix
+thread_local int gN;//dimension
+thread_local int gC;//concentration
 
-int gNodes;
+thread_local int gNodes;
 
 //generate nocviewer trace
-bool gTrace;
+thread_local bool gTrace;
 
-ostream * gWatchOut;
+thread_local ostream * gWatchOut;
 
 
 
@@ -150,19 +155,11 @@ bool Simulate( BookSimConfig const & config )
   return result;
 }
 
-
-int main( int argc, char **argv )
+/* Sets up the global state for the given configuration and runs it on the
+ * calling thread.
+ */
+bool RunSimulation( BookSimConfig const & config )
 {
-
-  BookSimConfig config;
-
-
-  if ( !ParseArgs( &config, argc, argv ) ) {
-    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
-    return 0;
- } 
-
-  
   /*initialize routing, traffic, injection functions
    */
   InitializeRoutingMap( config );
@@ -182,6 +179,198 @@ int main( int argc, char **argv )
 
   /*configure and run the simulator
    */
-  bool result = Simulate( config );
+  return Simulate( config );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+//Job driver
+//////////////////////
+
+/* While jobs are running, cout forwards its output to a buffer belonging
+ * to the job running on the calling thread, so that the output of
+ * concurrent simulations is not interleaved. If a job terminates the
+ * program (e.g. through Module::Error), whatever it has written so far is
+ * passed on before exiting so that the error message is not lost.
+ */
+class JobStreamBuf : public streambuf {
+  static streambuf * _default;
+  static thread_local stringbuf * _target;
+  inline streambuf * _Target( ) const {
+    return _target ? (streambuf *)_target : _default;
+  }
+  static void _FlushOnExit( ) {
+    if ( _target ) {
+      string const pending = _target->str( );
+      _target = NULL;
+      _default->sputn( pending.c_str( ), pending.size( ) );
+      _default->pubsync( );
+    }
+  }
+public:
+  JobStreamBuf( streambuf * def ) {
+    _default = def;
+    static bool registered = false;
+    if ( !registered ) {
+      atexit( _FlushOnExit );
+      registered = true;
+    }
+  }
+  static void SetTarget( stringbuf * target ) {
+    _target = target;
+  }
+protected:
+  int overflow( int c ) {
+    if ( c == traits_type::eof( ) ) {
+      return traits_type::not_eof( c );
+    }
+    return _Target( )->sputc( c );
+  }
+  streamsize xsputn( const char * s, streamsize n ) {
+    return _Target( )->sputn( s, n );
+  }
+  int sync( ) {
+    return _Target( )->pubsync( );
+  }
+};
+
+streambuf * JobStreamBuf::_default = NULL;
+thread_local stringbuf * JobStreamBuf::_target = NULL;
+
+/* Runs the simulations listed in a job file on a number of threads. Each
+ * line of the file lists parameter overrides (param=value, separated by
+ * whitespace) that are applied on top of the base configuration. The
+ * output of every job is printed in job order once the job has finished.
+ */
+class JobRunner {
+
+  struct sJob {
+    string params;
+    BookSimConfig config;
+    stringbuf output;
+    bool result;
+    bool done;
+  };
+
+  vector<sJob *> _jobs;
+
+  atomic<int> _next;
+  mutex _lock;
+  condition_variable _finished;
+
+  void _Worker( ) {
+    int j;
+    while ( ( j = _next++ ) < (int)_jobs.size( ) ) {
+      sJob * const job = _jobs[j];
+      JobStreamBuf::SetTarget( &job->output );
+      cout << "BEGIN Job " << j << ": " << job->params << endl;
+      job->result = RunSimulation( job->config );
+      cout << "END Job " << j << endl;
+      JobStreamBuf::SetTarget( NULL );
+      lock_guard<mutex> guard( _lock );
+      job->done = true;
+      _finished.notify_all( );
+    }
+  }
+
+public:
+
+  JobRunner( BookSimConfig const & config, string const & job_file ) 
+    : _next(0) {
+    ifstream in( job_file.c_str( ) );
+    if ( !in ) {
+      cerr << "Could not open job file " << job_file << endl;
+      exit( -1 );
+    }
+    string line;
+    while ( getline( in, line ) ) {
+      istringstream tokens( line );
+      string token;
+      if ( !( tokens >> token ) || ( token.compare( 0, 2, "//" ) == 0 ) ) {
+	continue;
+      }
+      // the configuration parser is not reentrant, so all jobs are set up
+      // here before any of them starts
+      sJob * const job = new sJob;
+      job->config = config;
+      do {
+	if ( token.find( '=' ) == string::npos ) {
+	  cerr << "Invalid parameter in job file: " << token << endl;
+	  exit( -1 );
+	}
+	job->config.ParseString( token );
+	job->params += ( job->params.empty( ) ? "" : " " ) + token;
+      } while ( tokens >> token );
+      job->result = false;
+      job->done = false;
+      _jobs.push_back( job );
+    }
+  }
+
+  ~JobRunner( ) {
+    for ( size_t j = 0; j < _jobs.size( ); ++j ) {
+      delete _jobs[j];
+    }
+  }
+
+  // Returns true if all jobs succeeded
+  bool Run( int threads ) {
+    streambuf * const out = cout.rdbuf( );
+    JobStreamBuf forward( out );
+    cout.rdbuf( &forward );
+
+    vector<thread> workers;
+    for ( int t = 0; t < threads; ++t ) {
+      workers.push_back( thread( &JobRunner::_Worker, this ) );
+    }
+
+    bool result = true;
+    for ( size_t j = 0; j < _jobs.size( ); ++j ) {
+      sJob * const job = _jobs[j];
+      {
+	unique_lock<mutex> guard( _lock );
+	while ( !job->done ) {
+	  _finished.wait( guard );
+	}
+      }
+      cout << job->output.str( ) << flush;
+      result &= job->result;
+    }
+
+    for ( size_t t = 0; t < workers.size( ); ++t ) {
+      workers[t].join( );
+    }
+
+    cout.rdbuf( out );
+    return result;
+  }
+
+};
+
+
+int main( int argc, char **argv )
+{
+
+  BookSimConfig config;
+
+
+  if ( !ParseArgs( &config, argc, argv ) ) {
+    cerr << "Usage: " << argv[0] << " configfile... [param=value...]" << endl;
+    return 0;
+ } 
+
+  
+  bool result;
+  string const job_file = config.GetStr( "job_file" );
+  if ( job_file == "" ) {
+    result = RunSimulation( config );
+  } else {
+    int const threads = config.GetInt( "job_threads" );
+    if ( threads < 1 ) {
+      cerr << "Number of job threads must be positive." << endl;
+      return -1;
+    }
+    JobRunner jobs( config, job_file );
+    result = jobs.Run( threads );
+  }
   return result ? -1 : 0;
 }
@@ -50,3 +50,29 @@ int log_two( int x )
 
   return r;
 }
+
+int first_set_bit( const unsigned long long * bits, int size, int start )
+{
+  int const words = ( size + 63 ) / 64;
+  int const first = start / 64;
+  unsigned long long word = bits[first] & ( ~0ULL << ( start % 64 ) );
+  for ( int w = first; ; ) {
+    if ( word ) {
+      return w * 64 + __builtin_ctzll(word);
+    }
+    if ( ++w == words ) {
+      break;
+    }
+    word = bits[w];
+  }
+  for ( int w = 0; w <= first; ++w ) {
+    word = bits[w];
+    if ( w == first ) {
+      word &= ( 1ULL << ( start % 64 ) ) - 1;
+    }
+    if ( word ) {
+      return w * 64 + __builtin_ctzll(word);
+    }
+  }
+  return -1;
+}
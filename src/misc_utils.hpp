@@ -31,4 +31,8 @@
 int log_two( int x );
 int powi( int x, int y );
 
+// the first set bit at or after start in a bit vector of the given
+// size, wrapping around, or -1 if no bit is set
+int first_set_bit( const unsigned long long * bits, int size, int start );
+
 #endif 
@@ -37,6 +37,7 @@
 
 #include "booksim.hpp"
 #include "module.hpp"
+#include "checkpoint.hpp"
 
 Module::Module( Module *parent, const string& name )
 {
@@ -71,6 +72,16 @@ void Module::DisplayHierarchy( int level, ostream & os ) const
   }
 }
 
+void Module::Serialize( Checkpoint & cp )
+{
+  cp.Section( _fullname );
+  _Serialize( cp );
+  for ( vector<Module *>::const_iterator mod_iter = _children.begin( );
+	mod_iter != _children.end( ); mod_iter++ ) {
+    (*mod_iter)->Serialize( cp );
+  }
+}
+
 void Module::Error( const string& msg ) const
 {
   cout << "Error in " << _fullname << " : " << msg << endl;
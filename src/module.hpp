@@ -34,6 +34,8 @@
 #include <vector>
 #include <iostream>
 
+class Checkpoint;
+
 class Module {
 private:
   string _name;
@@ -44,6 +46,10 @@ private:
 protected:
   void _AddChild( Module *child );
 
+  // saves or restores the state the module keeps between cycles, not
+  // including its children
+  virtual void _Serialize( Checkpoint & cp ) { }
+
 public:
   Module( Module *parent, const string& name );
   virtual ~Module( ) { }
@@ -57,6 +63,9 @@ public:
   void Debug( const string& msg ) const;
 
   virtual void Display( ostream & os = cout ) const;
+
+  // saves or restores the state of the module and its children
+  void Serialize( Checkpoint & cp );
 };
 
 #endif
@@ -60,10 +60,12 @@
 
 //#define DEBUG_FLATFLY
 
-static int _xcount;
-static int _ycount;
-static int _xrouter;
-static int _yrouter;
+// used by the routing functions, and installed on worker threads by 
+// SimContext
+thread_local int _xcount;
+thread_local int _ycount;
+thread_local int _xrouter;
+thread_local int _yrouter;
 
 FlatFlyOnChip::FlatFlyOnChip( const Configuration &config, const string & name ) :
   Network( config, name )
@@ -34,9 +34,12 @@
 
 #include <cassert>
 #include <sstream>
+#include <limits>
 
 #include "booksim.hpp"
 #include "network.hpp"
+#include "random_utils.hpp"
+#include "checkpoint.hpp"
 
 #include "kncube.hpp"
 #include "fly.hpp"
@@ -56,10 +59,30 @@ Network::Network( const Configuration &config, const string & name ) :
   _nodes    = -1; 
   _channels = -1;
   _classes  = config.GetInt("classes");
+
+  _threads  = config.GetInt("threads");
+  if ( _threads < 1 ) {
+    Error( "Number of threads must be positive." );
+  }
+  // watch and trace output is written by the modules themselves, so its
+  // order would depend on thread scheduling
+  if ( ( _threads > 1 ) && ( gWatchOut || gTrace ) ) {
+    cout << "WARNING: Watch and trace output require serial evaluation; ignoring threads = "
+	 << _threads << "." << endl;
+    _threads = 1;
+  }
+  _pool = NULL;
+
+  _wake_list = (config.GetInt("wake_list") > 0);
+  _wakeups = NULL;
+
+  _timing_wheel = _wake_list && (config.GetInt("timing_wheel") > 0);
 }
 
 Network::~Network( )
 {
+  if ( _pool ) delete _pool;
+  if ( _wakeups ) delete [] _wakeups;
   for ( int r = 0; r < _size; ++r ) {
     if ( _routers[r] ) delete _routers[r];
   }
@@ -179,30 +202,239 @@ void Network::_Alloc( )
   }
 }
 
+/* Within each phase, a module only touches its own state and its side of
+ * the channels it is attached to (routers read a channel's output and write
+ * its input, channels move input to output), so the modules of a phase can
+ * be evaluated in any order. When running on multiple threads, routers and
+ * channels are split into contiguous blocks so that neighboring routers
+ * tend to share a partition.
+ */
+void Network::_Schedule( )
+{
+  if ( _threads == 1 ) {
+    _schedule.assign(_timed_modules.begin(), _timed_modules.end());
+    _bounds.push_back(0);
+    _bounds.push_back(_schedule.size());
+  } else {
+    vector<TimedModule *> routers;
+    vector<TimedModule *> channels;
+    for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
+	iter != _timed_modules.end();
+	++iter) {
+      if ( dynamic_cast<Router *>(*iter) ) {
+	routers.push_back(*iter);
+      } else {
+	channels.push_back(*iter);
+      }
+    }
+    _bounds.push_back(0);
+    for ( int t = 0; t < _threads; ++t ) {
+      _schedule.insert(_schedule.end(), 
+		       routers.begin() + t * routers.size() / _threads,
+		       routers.begin() + (t + 1) * routers.size() / _threads);
+      _schedule.insert(_schedule.end(), 
+		       channels.begin() + t * channels.size() / _threads,
+		       channels.begin() + (t + 1) * channels.size() / _threads);
+      _bounds.push_back(_schedule.size());
+    }
+
+    cout << Name() << ": evaluating " << routers.size() << " routers and "
+	 << channels.size() << " channels on " << _threads << " threads." << endl;
+
+    _pool = new ThreadPool(_threads);
+  }
+
+  if ( _wake_list ) {
+    int const modules = _schedule.size();
+    int const words = (modules + 63) / 64;
+    // everything starts out awake; idle modules drop out after one cycle
+    _awake.resize(words, ~0ULL);
+    if ( modules % 64 ) {
+      _awake[words - 1] = (1ULL << (modules % 64)) - 1;
+    }
+    _wakeups = new atomic<unsigned long long>[words];
+    for ( int w = 0; w < words; ++w ) {
+      _wakeups[w] = 0;
+    }
+    for ( int m = 0; m < modules; ++m ) {
+      _schedule[m]->SetWakeFlag(&_wakeups[m / 64], 1ULL << (m % 64));
+    }
+  }
+
+  if ( _timing_wheel ) {
+    // deliveries are never further ahead than the longest channel delay
+    int slots = 1;
+    for ( int n = 0; n < _nodes; ++n ) {
+      slots = max(slots, _inject[n]->GetLatency());
+      slots = max(slots, _inject_cred[n]->GetLatency());
+      slots = max(slots, _eject[n]->GetLatency());
+      slots = max(slots, _eject_cred[n]->GetLatency());
+    }
+    for ( int c = 0; c < _channels; ++c ) {
+      slots = max(slots, _chan[c]->GetLatency());
+      slots = max(slots, _chan_cred[c]->GetLatency());
+    }
+    _wheel.resize(slots + 1);
+  }
+}
+
+// moves the modules sleeping until the given cycle back onto the wake list
+void Network::_ExpandWheel( int time )
+{
+  vector<int> & bucket = _wheel[time % _wheel.size()];
+  for ( size_t i = 0; i < bucket.size(); ++i ) {
+    _awake[bucket[i] / 64] |= 1ULL << (bucket[i] % 64);
+  }
+  bucket.clear();
+}
+
+void Network::_Visit( int begin, int end, void (TimedModule::*phase)( ) )
+{
+  if ( !_wake_list ) {
+    for ( int m = begin; m < end; ++m ) {
+      SelectRandomStream( _schedule[m]->RandomStream( ) );
+      (_schedule[m]->*phase)( );
+    }
+    SelectRandomStream( NULL );
+    return;
+  }
+  for ( int w = begin / 64; w * 64 < end; ++w ) {
+    unsigned long long bits = _awake[w];
+    if ( w * 64 < begin ) {
+      bits &= ~0ULL << (begin - w * 64);
+    }
+    if ( end - w * 64 < 64 ) {
+      bits &= (1ULL << (end - w * 64)) - 1;
+    }
+    while ( bits ) {
+      int const b = __builtin_ctzll(bits);
+      bits &= bits - 1;
+      SelectRandomStream( _schedule[w * 64 + b]->RandomStream( ) );
+      (_schedule[w * 64 + b]->*phase)( );
+    }
+  }
+  SelectRandomStream( NULL );
+}
+
+// the streams only depend on the seed and the order in which the modules
+// were built, not on how they are split between threads
+void Network::SeedRandom( long seed )
+{
+  for ( size_t m = 0; m < _timed_modules.size( ); ++m ) {
+    unsigned long long s = ( (unsigned long long)seed << 32 ) ^ m;
+    *_timed_modules[m]->RandomStream( ) = RandomStreamNext( s );
+  }
+}
+
+// runs serially after the output phase, so modules woken up during the
+// cycle (which may not consider themselves busy yet) are never dropped
+void Network::_UpdateAwake( )
+{
+  int const now = GetSimTime( );
+  for ( size_t w = 0; w < _awake.size(); ++w ) {
+    unsigned long long bits = _awake[w];
+    unsigned long long awake = bits;
+    while ( bits ) {
+      int const b = __builtin_ctzll(bits);
+      bits &= bits - 1;
+      TimedModule const * const module = _schedule[w * 64 + b];
+      if ( module->Idle( ) ) {
+	awake &= ~(1ULL << b);
+      } else if ( _timing_wheel ) {
+	int const next = module->NextEventTime( );
+	if ( next > now + 1 ) {
+	  awake &= ~(1ULL << b);
+	  if ( next < numeric_limits<int>::max( ) ) {
+	    _wheel[next % _wheel.size()].push_back(w * 64 + b);
+	  }
+	}
+      }
+    }
+    _awake[w] = awake | _wakeups[w].exchange(0, memory_order_relaxed);
+  }
+}
+
+int Network::NextEventTime( ) const
+{
+  int const now = GetSimTime( );
+  if ( _bounds.empty( ) ) {
+    return now;
+  }
+  int next = numeric_limits<int>::max( );
+  if ( !_wake_list ) {
+    for ( size_t m = 0; m < _schedule.size( ); ++m ) {
+      next = min(next, _schedule[m]->NextEventTime( ));
+      if ( next <= now ) {
+	return now;
+      }
+    }
+    return next;
+  }
+  for ( size_t w = 0; w < _awake.size( ); ++w ) {
+    if ( _wakeups[w].load(memory_order_relaxed) ) {
+      return now;
+    }
+    unsigned long long bits = _awake[w];
+    while ( bits ) {
+      int const b = __builtin_ctzll(bits);
+      bits &= bits - 1;
+      next = min(next, _schedule[w * 64 + b]->NextEventTime( ));
+      if ( next <= now ) {
+	return now;
+      }
+    }
+  }
+  for ( size_t d = 0; d < _wheel.size( ); ++d ) {
+    if ( !_wheel[(now + d) % _wheel.size()].empty( ) ) {
+      next = min(next, int(now + d));
+      break;
+    }
+  }
+  return next;
+}
+
+class Network::PhaseTask : public ThreadPool::Task {
+  Network * _net;
+  void (TimedModule::*_phase)( );
+public:
+  PhaseTask( Network * net, void (TimedModule::*phase)( ) )
+    : _net(net), _phase(phase) {}
+  void Execute( int thread ) {
+    _net->_Visit(_net->_bounds[thread], _net->_bounds[thread + 1], _phase);
+  }
+};
+
+void Network::_RunPhase( void (TimedModule::*phase)( ) )
+{
+  if ( _bounds.empty( ) ) {
+    _Schedule( );
+  }
+  if ( !_pool ) {
+    _Visit(0, _schedule.size(), phase);
+  } else {
+    PhaseTask task(this, phase);
+    _pool->Run(&task);
+  }
+}
+
 void Network::ReadInputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->ReadInputs( );
+  if ( _timing_wheel && !_bounds.empty( ) ) {
+    _ExpandWheel( GetSimTime( ) );
   }
+  _RunPhase( &TimedModule::ReadInputs );
 }
 
 void Network::Evaluate( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->Evaluate( );
-  }
+  _RunPhase( &TimedModule::Evaluate );
 }
 
 void Network::WriteOutputs( )
 {
-  for(deque<TimedModule *>::const_iterator iter = _timed_modules.begin();
-      iter != _timed_modules.end();
-      ++iter) {
-    (*iter)->WriteOutputs( );
+  _RunPhase( &TimedModule::WriteOutputs );
+  if ( _wake_list ) {
+    _UpdateAwake( );
   }
 }
 
@@ -250,6 +482,37 @@ double Network::Capacity( ) const
  * neceesary of the network, by default, call display on each router
  * and display the channel utilization rate
  */
+// the routers and channels are saved as children; which of them are awake
+// does not affect the results, so a restored network starts out with all 
+// of them awake, as a new one does
+void Network::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "routers", _size );
+  cp.Check( "nodes", _nodes );
+  cp.Check( "channels", _channels );
+  vector<unsigned long long> streams( _timed_modules.size( ) );
+  for ( size_t m = 0; m < _timed_modules.size( ); ++m ) {
+    streams[m] = *_timed_modules[m]->RandomStream( );
+  }
+  cp.Value( streams );
+  for ( size_t m = 0; m < _timed_modules.size( ); ++m ) {
+    *_timed_modules[m]->RandomStream( ) = streams[m];
+  }
+  if ( cp.Restoring( ) && _wake_list && !_bounds.empty( ) ) {
+    int const modules = _schedule.size( );
+    _awake.assign( _awake.size( ), ~0ULL );
+    if ( modules % 64 ) {
+      _awake.back( ) = (1ULL << (modules % 64)) - 1;
+    }
+    for ( size_t w = 0; w < _awake.size( ); ++w ) {
+      _wakeups[w] = 0;
+    }
+    for ( size_t b = 0; b < _wheel.size( ); ++b ) {
+      _wheel[b].clear( );
+    }
+  }
+}
+
 void Network::Display( ostream & os ) const
 {
   for ( int r = 0; r < _size; ++r ) {
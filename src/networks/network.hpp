@@ -41,6 +41,7 @@
 #include "channel.hpp"
 #include "config_utils.hpp"
 #include "globals.hpp"
+#include "thread_pool.hpp"
 
 typedef Channel<Credit> CreditChannel;
 
@@ -66,11 +67,40 @@ protected:
 
   deque<TimedModule *> _timed_modules;
 
+  // modules in evaluation order; with multiple threads, each thread
+  // evaluates the range [_bounds[t], _bounds[t+1])
+  vector<TimedModule *> _schedule;
+  vector<int> _bounds;
+  int _threads;
+  ThreadPool * _pool;
+
+  // wake-list scheduling: only modules with their bit set in _awake are
+  // evaluated; modules woken during a cycle are added at the end of it
+  bool _wake_list;
+  vector<unsigned long long> _awake;
+  atomic<unsigned long long> * _wakeups;
+
+  // timing wheel: channels whose next delivery is more than a cycle away
+  // sleep in the bucket for their delivery cycle, modulo the wheel size
+  bool _timing_wheel;
+  vector<vector<int> > _wheel;
+
+  void _ExpandWheel( int time );
+
+  class PhaseTask;
+
   virtual void _ComputeSize( const Configuration &config ) = 0;
   virtual void _BuildNet( const Configuration &config ) = 0;
 
   void _Alloc( );
 
+  void _Schedule( );
+  void _RunPhase( void (TimedModule::*phase)( ) );
+  void _Visit( int begin, int end, void (TimedModule::*phase)( ) );
+  void _UpdateAwake( );
+
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   Network( const Configuration &config, const string & name );
   virtual ~Network( );
@@ -94,6 +124,11 @@ public:
   virtual void Evaluate( );
   virtual void WriteOutputs( );
 
+  virtual int NextEventTime( ) const;
+
+  // Seeds the random streams of the routers and channels
+  void SeedRandom( long seed );
+
   void Display( ostream & os = cout ) const;
   void DumpChannelMap( ostream & os = cout, string const & prefix = "" ) const;
   void DumpNodeMap( ostream & os = cout, string const & prefix = "" ) const;
@@ -112,6 +147,7 @@ public:
   const vector<Router *> & GetRouters(){return _routers;}
   Router * GetRouter(int index) {return _routers[index];}
   int NumRouters() const {return _size;}
+  int NumThreads() const {return _threads;}
 };
 
 #endif 
@@ -38,9 +38,42 @@
 #include "booksim.hpp"
 #include "outputset.hpp"
 
+void OutputSet::ElementList::_Clear( )
+{
+  _size = 0;
+  _spill.clear( );
+}
+
+void OutputSet::ElementList::_Insert( const sSetElement & s )
+{
+  sSetElement * elements = _spill.empty( ) ? _inline : &_spill[0];
+
+  // higher priorities first; drop duplicates of an existing priority
+  int pos = 0;
+  while ( ( pos < _size ) && ( elements[pos].pri > s.pri ) ) {
+    ++pos;
+  }
+  if ( ( pos < _size ) && ( elements[pos].pri == s.pri ) ) {
+    return;
+  }
+
+  if ( _spill.empty( ) && ( _size < _inline_size ) ) {
+    for ( int i = _size; i > pos; --i ) {
+      _inline[i] = _inline[i-1];
+    }
+    _inline[pos] = s;
+  } else {
+    if ( _spill.empty( ) ) {
+      _spill.assign( _inline, _inline + _size );
+    }
+    _spill.insert( _spill.begin( ) + pos, s );
+  }
+  ++_size;
+}
+
 void OutputSet::Clear( )
 {
-  _outputs.clear( );
+  _outputs._Clear( );
 }
 
 void OutputSet::Add( int output_port, int vc, int pri  )
@@ -57,14 +90,14 @@ void OutputSet::AddRange( int output_port, int vc_start, int vc_end, int pri )
   s.vc_end   = vc_end;
   s.pri      = pri;
   s.output_port = output_port;
-  _outputs.insert( s );
+  _outputs._Insert( s );
 }
 
 //legacy support, for performance, just use GetSet()
 int OutputSet::NumVCs( int output_port ) const
 {
   int total = 0;
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementList::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       total += (i->vc_end - i->vc_start + 1);
@@ -76,7 +109,7 @@ int OutputSet::NumVCs( int output_port ) const
 
 bool OutputSet::OutputEmpty( int output_port ) const
 {
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementList::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       return false;
@@ -87,7 +120,7 @@ bool OutputSet::OutputEmpty( int output_port ) const
 }
 
 
-const set<OutputSet::sSetElement> & OutputSet::GetSet() const{
+const OutputSet::ElementList & OutputSet::GetSet() const{
   return _outputs;
 }
 
@@ -101,7 +134,7 @@ int OutputSet::GetVC( int output_port, int vc_index, int *pri ) const
   
   if ( pri ) { *pri = -1; }
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementList::const_iterator i = _outputs.begin( );
   while(i!=_outputs.end( )){
     if(i->output_port == output_port){
       range = i->vc_end - i->vc_start + 1;
@@ -128,7 +161,7 @@ bool OutputSet::GetPortVC( int *out_port, int *out_vc ) const
   bool single_output = false;
   int  used_outputs  = 0;
 
-  set<sSetElement>::const_iterator i = _outputs.begin( );
+  ElementList::const_iterator i = _outputs.begin( );
   if(i!=_outputs.end( )){
     used_outputs = i->output_port;
   }
@@ -28,7 +28,7 @@
 #ifndef _OUTPUTSET_HPP_
 #define _OUTPUTSET_HPP_
 
-#include <set>
+#include <vector>
 
 class OutputSet {
 
@@ -41,6 +41,36 @@ public:
     int output_port;
   };
 
+  // Elements in order of decreasing priority. As with a set ordered by 
+  // priority, only the first element added for each priority is kept. 
+  // Route sets rarely hold more than a few priorities, so the elements 
+  // live in a small inline buffer and only spill to the heap beyond that.
+  class ElementList {
+  public:
+    typedef const sSetElement * const_iterator;
+
+    ElementList( ) : _size( 0 ) { }
+
+    inline const_iterator begin( ) const {
+      return _spill.empty( ) ? _inline : &_spill[0];
+    }
+    inline const_iterator end( ) const { return begin( ) + _size; }
+    inline int size( ) const { return _size; }
+    inline bool empty( ) const { return _size == 0; }
+
+  private:
+    friend class OutputSet;
+
+    enum { _inline_size = 4 };
+
+    sSetElement _inline[_inline_size];
+    vector<sSetElement> _spill;
+    int _size;
+
+    void _Clear( );
+    void _Insert( const sSetElement & s );
+  };
+
   void Clear( );
   void Add( int output_port, int vc, int pri = 0 );
   void AddRange( int output_port, int vc_start, int vc_end, int pri = 0 );
@@ -48,19 +78,14 @@ public:
   bool OutputEmpty( int output_port ) const;
   int NumVCs( int output_port ) const;
   
-  const set<sSetElement> & GetSet() const;
+  const ElementList & GetSet() const;
 
   int  GetVC( int output_port,  int vc_index, int *pri = 0 ) const;
   bool GetPortVC( int *out_port, int *out_vc ) const;
 private:
-  set<sSetElement> _outputs;
+  ElementList _outputs;
 };
 
-inline bool operator<(const OutputSet::sSetElement & se1, 
-	       const OutputSet::sSetElement & se2) {
-  return se1.pri > se2.pri; // higher priorities first!
-}
-
 #endif
 
 
@@ -27,8 +27,8 @@
 
 #include "packet_reply_info.hpp"
 
-stack<PacketReplyInfo*> PacketReplyInfo::_all;
-stack<PacketReplyInfo*> PacketReplyInfo::_free;
+thread_local stack<PacketReplyInfo*> PacketReplyInfo::_all;
+thread_local stack<PacketReplyInfo*> PacketReplyInfo::_free;
 
 PacketReplyInfo * PacketReplyInfo::New()
 {
@@ -47,8 +47,8 @@ public:
 
 private:
 
-  static stack<PacketReplyInfo*> _all;
-  static stack<PacketReplyInfo*> _free;
+  static thread_local stack<PacketReplyInfo*> _all;
+  static thread_local stack<PacketReplyInfo*> _free;
 
   PacketReplyInfo() {}
   ~PacketReplyInfo() {}
@@ -28,6 +28,7 @@
 #include "buffer_monitor.hpp"
 
 #include "flit.hpp"
+#include "checkpoint.hpp"
 
 BufferMonitor::BufferMonitor( int inputs, int classes ) 
 : _cycles(0), _inputs(inputs), _classes(classes) {
@@ -53,6 +54,12 @@ void BufferMonitor::read( int input, Flit const * f ) {
   _reads[ index(input, f->cl) ]++ ;
 }
 
+void BufferMonitor::Serialize(Checkpoint & cp) {
+  cp.Value(_cycles);
+  cp.Value(_reads);
+  cp.Value(_writes);
+}
+
 void BufferMonitor::display(ostream & os) const {
   for ( int i = 0 ; i < _inputs ; i++ ) {
     os << "[ " << i << " ] " ;
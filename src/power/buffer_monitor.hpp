@@ -34,6 +34,7 @@
 using namespace std;
 
 class Flit;
+class Checkpoint;
 
 class BufferMonitor {
   int  _cycles ;
@@ -61,6 +62,8 @@ public:
   }
   void display(ostream & os) const;
 
+  void Serialize(Checkpoint & cp);
+
 } ;
 
 ostream & operator<<( ostream & os, BufferMonitor const & obj ) ;
@@ -34,6 +34,7 @@
 using namespace std;
 
 class Flit;
+class Checkpoint;
 
 class SwitchMonitor {
   int  _cycles ;
@@ -59,6 +60,8 @@ public:
   }
   void traversal( int input, int output, Flit const * f ) ;
   void display(ostream & os) const;
+
+  void Serialize(Checkpoint & cp);
 } ;
 
 ostream & operator<<( ostream & os, SwitchMonitor const & obj ) ;
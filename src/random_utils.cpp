@@ -29,8 +29,8 @@
 #include <algorithm>
 #include <cassert>
 
-extern long ran_x[];
-extern double ran_u[];
+extern thread_local long ran_x[];
+extern thread_local double ran_u[];
 #define KK 100
 
 void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u ) {
@@ -44,3 +44,30 @@ void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> c
   assert(save_u.size() == KK);
   std::copy(save_u.begin(), save_u.end(), ran_u);
 }
+
+// hashes the complete state of both generators, including the position in
+// the values generated ahead of time; the result leaves room for adding a
+// thread index and still being a valid seed for both generators
+long RandomStreamSeed( long salt ) {
+  std::vector<long> state_x;
+  std::vector<double> state_u;
+  SaveFullRandomState( state_x, state_u );
+  unsigned long long h = 14695981039346656037ULL ^ (unsigned long long)salt;
+  for ( size_t i = 0; i < state_x.size(); ++i ) {
+    h = ( h ^ (unsigned long long)state_x[i] ) * 1099511628211ULL;
+  }
+  for ( size_t i = 0; i < state_u.size(); ++i ) {
+    h = ( h ^ (unsigned long long)( state_u[i] * 9007199254740992.0 ) ) * 1099511628211ULL;
+  }
+  return (long)( h % ( 1ULL << 29 ) );
+}
+
+static thread_local unsigned long long * _random_stream = NULL;
+
+void SelectRandomStream( unsigned long long * stream ) {
+  _random_stream = stream;
+}
+
+unsigned long long * SelectedRandomStream( ) {
+  return _random_stream;
+}
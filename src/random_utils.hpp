@@ -35,6 +35,10 @@ void   ran_start(long seed);
 long   ran_next( );
 void   ranf_start(long seed);
 double ranf_next( );
+void   ran_get_state( std::vector<long> & state );
+void   ran_set_state( std::vector<long> const & state );
+void   ranf_get_state( std::vector<double> & state );
+void   ranf_set_state( std::vector<double> const & state );
 
 inline void RandomSeed( long seed ) {
   ran_start( seed );
@@ -66,4 +70,38 @@ void SaveRandomState( std::vector<long> & save_x, std::vector<double> & save_u )
 // Restores the generator state from previously saved values
 void RestoreRandomState( std::vector<long> const & save_x, std::vector<double> const & save_u );
 
+// Saves the complete state of both generators, including the values they 
+// have generated ahead of time; unlike RestoreRandomState, restoring it 
+// continues the exact sequence of values the saved generators would draw
+inline void SaveFullRandomState( std::vector<long> & state_x, 
+				 std::vector<double> & state_u ) {
+  ran_get_state( state_x );
+  ranf_get_state( state_u );
+}
+inline void RestoreFullRandomState( std::vector<long> const & state_x, 
+				    std::vector<double> const & state_u ) {
+  ran_set_state( state_x );
+  ranf_set_state( state_u );
+}
+
+// Derives a seed for an independent generator from the current state of
+// this one and the given salt, without drawing from it
+long RandomStreamSeed( long salt );
+
+// While a stream is selected, the values drawn on the calling thread come
+// from it instead of from the thread's generator. A stream is a single
+// 64-bit word advanced by SplitMix64; network modules are given streams of
+// their own (see timed_module.hpp), so that their draws do not depend on
+// the thread that evaluates them or on the order of evaluation.
+void SelectRandomStream( unsigned long long * stream );
+unsigned long long * SelectedRandomStream( );
+
+inline unsigned long long RandomStreamNext( unsigned long long & stream ) {
+  unsigned long long z = ( stream += 0x9E3779B97F4A7C15ULL );
+  z = ( z ^ ( z >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+  z = ( z ^ ( z >> 27 ) ) * 0x94D049BB133111EBULL;
+  return z ^ ( z >> 31 );
+}
+
+
 #endif
@@ -25,10 +25,51 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <cassert>
+
+#include "random_utils.hpp"
+
+// every simulation thread has its own generator
+#define RNG_STATE thread_local
 #define main rng_double_main
 #include "rng-double.c"
 
 double ranf_next( )
 {
+  unsigned long long * const stream = SelectedRandomStream( );
+  if ( stream ) {
+    return ( RandomStreamNext( *stream ) >> 11 ) * ( 1.0 / 9007199254740992.0 );
+  }
   return ranf_arr_next( );
 }
+
+// laid out as for ran_get_state
+void ranf_get_state( std::vector<double> & state )
+{
+  state.assign(ran_u, ran_u + KK);
+  state.insert(state.end(), ranf_arr_buf, ranf_arr_buf + QUALITY);
+  if ( ranf_arr_ptr == &ranf_arr_dummy ) {
+    state.push_back(-2.0);
+  } else if ( ranf_arr_ptr == &ranf_arr_started ) {
+    state.push_back(-1.0);
+  } else {
+    state.push_back((double)(ranf_arr_ptr - ranf_arr_buf));
+  }
+}
+
+void ranf_set_state( std::vector<double> const & state )
+{
+  assert(state.size() == KK + QUALITY + 1);
+  std::copy(state.begin(), state.begin() + KK, ran_u);
+  std::copy(state.begin() + KK, state.begin() + KK + QUALITY, ranf_arr_buf);
+  int const pos = (int)state.back();
+  if ( pos == -2 ) {
+    ranf_arr_ptr = &ranf_arr_dummy;
+  } else if ( pos == -1 ) {
+    ranf_arr_ptr = &ranf_arr_started;
+  } else {
+    assert((pos >= 0) && (pos <= KK));
+    ranf_arr_ptr = ranf_arr_buf + pos;
+  }
+}
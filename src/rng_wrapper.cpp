@@ -25,10 +25,53 @@
  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <cassert>
+
+#include "random_utils.hpp"
+
+// every simulation thread has its own generator
+#define RNG_STATE thread_local
 #define main rng_main
 #include "rng.c"
 
+// a selected stream yields the same 30-bit range as the generator
 long ran_next( )
 {
+  unsigned long long * const stream = SelectedRandomStream( );
+  if ( stream ) {
+    return (long)( RandomStreamNext( *stream ) >> 34 );
+  }
   return ran_arr_next( );
 }
+
+// the state is followed by the values generated ahead and the position of
+// the next one, or -1 (-2) if the buffer is yet to be filled (seeded)
+void ran_get_state( std::vector<long> & state )
+{
+  state.assign(ran_x, ran_x + KK);
+  state.insert(state.end(), ran_arr_buf, ran_arr_buf + QUALITY);
+  if ( ran_arr_ptr == &ran_arr_dummy ) {
+    state.push_back(-2);
+  } else if ( ran_arr_ptr == &ran_arr_started ) {
+    state.push_back(-1);
+  } else {
+    state.push_back(ran_arr_ptr - ran_arr_buf);
+  }
+}
+
+void ran_set_state( std::vector<long> const & state )
+{
+  assert(state.size() == KK + QUALITY + 1);
+  std::copy(state.begin(), state.begin() + KK, ran_x);
+  std::copy(state.begin() + KK, state.begin() + KK + QUALITY, ran_arr_buf);
+  long const pos = state.back();
+  if ( pos == -2 ) {
+    ran_arr_ptr = &ran_arr_dummy;
+  } else if ( pos == -1 ) {
+    ran_arr_ptr = &ran_arr_started;
+  } else {
+    assert((pos >= 0) && (pos <= KK));
+    ran_arr_ptr = ran_arr_buf + pos;
+  }
+}
@@ -52,11 +52,11 @@
 
 
 
-map<string, tRoutingFunction> gRoutingFunctionMap;
+thread_local map<string, tRoutingFunction> gRoutingFunctionMap;
 
 /* Global information used by routing functions */
 
-int gNumVCs;
+thread_local int gNumVCs;
 
 /* Add more functions here
  *
@@ -64,10 +64,10 @@ int gNumVCs;
 
 // ============================================================
 //  Balfour-Schultz
-int gReadReqBeginVC, gReadReqEndVC;
-int gWriteReqBeginVC, gWriteReqEndVC;
-int gReadReplyBeginVC, gReadReplyEndVC;
-int gWriteReplyBeginVC, gWriteReplyEndVC;
+thread_local int gReadReqBeginVC, gReadReqEndVC;
+thread_local int gWriteReqBeginVC, gWriteReqEndVC;
+thread_local int gReadReplyBeginVC, gReadReplyEndVC;
+thread_local int gWriteReplyBeginVC, gWriteReplyEndVC;
 
 // ============================================================
 //  QTree: Nearest Common Ancestor
@@ -37,12 +37,12 @@ typedef void (*tRoutingFunction)( const Router *, const Flit *, int in_channel,
 
 void InitializeRoutingMap( const Configuration & config );
 
-extern map<string, tRoutingFunction> gRoutingFunctionMap;
+extern thread_local map<string, tRoutingFunction> gRoutingFunctionMap;
 
-extern int gNumVCs;
-extern int gReadReqBeginVC, gReadReqEndVC;
-extern int gWriteReqBeginVC, gWriteReqEndVC;
-extern int gReadReplyBeginVC, gReadReplyEndVC;
-extern int gWriteReplyBeginVC, gWriteReplyEndVC;
+extern thread_local int gNumVCs;
+extern thread_local int gReadReqBeginVC, gReadReqEndVC;
+extern thread_local int gWriteReqBeginVC, gWriteReqEndVC;
+extern thread_local int gReadReplyBeginVC, gReadReplyEndVC;
+extern thread_local int gWriteReplyBeginVC, gWriteReplyEndVC;
 
 #endif
@@ -581,7 +581,7 @@ void ChaosRouter::_OutputAdvance( )
 	}
 	
 	c = Credit::New( );
-	c->vc.insert(0);
+	c->AddVC(0);
 	_credit_queue[i].push( c );
       }
     }
@@ -668,6 +668,11 @@ void ChaosRouter::_SendCredits( )
   }
 }
 
+void ChaosRouter::_Serialize( Checkpoint & cp )
+{
+  Error( "Checkpoints are not supported for chaos routers." );
+}
+
 void ChaosRouter::Display( ostream & os ) const
 {
 }
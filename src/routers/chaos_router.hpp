@@ -104,6 +104,8 @@ class ChaosRouter : public Router {
 
   virtual void _InternalStep( );
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   ChaosRouter( const Configuration& config,
 	    Module *parent, const string & name, int id,
@@ -46,6 +46,12 @@ EventRouter::EventRouter( const Configuration& config,
   ostringstream module_name;
   
   _vcs            = config.GetInt( "num_vcs" );
+  if ( _vcs > Credit::max_vcs ) {
+    ostringstream err;
+    err << "Number of VCs exceeds the maximum of " << Credit::max_vcs
+	<< " supported by credits";
+    Error( err.str( ) );
+  }
 
   // Cut-through mode --- packets are not broken
   // up and input buffers are assumed to be 
@@ -470,8 +476,8 @@ void EventRouter::_ArrivalArb( int output )
     c = _out_cred_buffer[output].front( );
     _out_cred_buffer[output].pop( );
     
-    assert( c->vc.size() == 1 );
-    int vc = *c->vc.begin();
+    assert( c->NumVCs() == 1 );
+    int vc = c->FirstVC( );
 
     EventNextVCState::eNextVCState state = 
       _output_state[output]->GetState( vc );
@@ -671,7 +677,7 @@ void EventRouter::_TransportArb( int input )
     }
 
     c = Credit::New( );
-    c->vc.insert(f->vc);
+    c->AddVC(f->vc);
     c->head          = f->head;
     c->tail          = f->tail;
     c->id            = f->id;
@@ -740,6 +746,11 @@ void EventRouter::_SendCredits( )
   }
 }
 
+void EventRouter::_Serialize( Checkpoint & cp )
+{
+  Error( "Checkpoints are not supported for event routers." );
+}
+
 void EventRouter::Display( ostream & os ) const
 {
   for ( int input = 0; input < _inputs; ++input ) {
@@ -160,6 +160,8 @@ class EventRouter : public Router {
 
   virtual void _InternalStep( );
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   EventRouter( const Configuration& config,
 	       Module *parent, const string & name, int id,
@@ -34,9 +34,11 @@
 #include <cstdlib>
 #include <cassert>
 #include <limits>
+#include <cmath>
 
 #include "globals.hpp"
 #include "random_utils.hpp"
+#include "misc_utils.hpp"
 #include "vc.hpp"
 #include "routefunc.hpp"
 #include "outputset.hpp"
@@ -46,6 +48,7 @@
 #include "allocator.hpp"
 #include "switch_monitor.hpp"
 #include "buffer_monitor.hpp"
+#include "checkpoint.hpp"
 
 IQRouter::IQRouter( Configuration const & config, Module *parent, 
 		    string const & name, int id, int inputs, int outputs )
@@ -162,6 +165,19 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
   _output_buffer.resize(_outputs); 
   _credit_buffer.resize(_inputs); 
 
+  // Pipeline stages; every input VC is in each stage at most once, and the
+  // crossbar holds at most one flit per expanded input and cycle in flight
+  int const port_words = (_inputs + 63) / 64;
+  _in_queue_flits.resize(_inputs, NULL);
+  _in_queue_mask.resize(port_words, 0);
+  _out_queue_credits.resize(_inputs, NULL);
+  _out_queue_mask.resize(port_words, 0);
+  _route_vcs.Reserve(_inputs*_vcs);
+  _vc_alloc_vcs.Reserve(_inputs*_vcs);
+  _sw_hold_vcs.Reserve(_inputs*_vcs);
+  _sw_alloc_vcs.Reserve(_inputs*_vcs);
+  _crossbar_flits.Reserve(_inputs*_input_speedup*(_crossbar_delay+1));
+
   // Switch configuration (when held for multiple cycles)
   _hold_switch_for_packet = (config.GetInt("hold_switch_for_packet") > 0);
   _switch_hold_in.resize(_inputs*_input_speedup, -1);
@@ -180,6 +196,91 @@ IQRouter::IQRouter( Configuration const & config, Module *parent,
 #endif
 }
 
+void IQRouter::StageQueue::Reserve( int entries )
+{
+  while(_mask + 1 < entries) {
+    _Grow( );
+  }
+}
+
+void IQRouter::StageQueue::_Grow( )
+{
+  int const capacity = (_mask < 0) ? 1 : 2 * (_mask + 1);
+  vector<int> time(capacity), input(capacity), vc(capacity), output(capacity);
+  vector<Flit *> flit(capacity);
+  for(int n = 0; n < _size; ++n) {
+    int const i = (_head + n) & _mask;
+    time[n] = _time[i];
+    input[n] = _input[i];
+    vc[n] = _vc[i];
+    output[n] = _output[i];
+    flit[n] = _flit[i];
+  }
+  _time.swap(time);
+  _input.swap(input);
+  _vc.swap(vc);
+  _output.swap(output);
+  _flit.swap(flit);
+  _head = 0;
+  _mask = capacity - 1;
+}
+
+void IQRouter::StageQueue::Serialize( Checkpoint & cp )
+{
+  int const size = cp.Size( _size );
+  if ( cp.Restoring( ) ) {
+    _head = 0;
+    _size = 0;
+    Reserve( size );
+    _size = size;
+  }
+  for(int n = 0; n < _size; ++n) {
+    int const i = (_head + n) & _mask;
+    cp.Value( _time[i] );
+    cp.Value( _input[i] );
+    cp.Value( _vc[i] );
+    cp.Value( _output[i] );
+    cp.Value( _flit[i] );
+  }
+}
+
+template<class P>
+inline bool IQRouter::_Speculative( ) const
+{
+  return P::generic ? _speculative : P::speculative;
+}
+
+template<class P>
+inline bool IQRouter::_Lookahead( ) const
+{
+  return P::generic ? !_routing_delay : P::lookahead;
+}
+
+template<class P>
+inline bool IQRouter::_HoldSwitch( ) const
+{
+  return P::generic ? _hold_switch_for_packet : P::hold_switch;
+}
+
+template<class P>
+inline bool IQRouter::_NOQ( ) const
+{
+  return P::generic ? _noq : P::noq;
+}
+
+template<class P>
+inline bool IQRouter::_VCBusyWhenFull( ) const
+{
+  return P::generic ? _vc_busy_when_full : P::vc_busy_when_full;
+}
+
+// specialized variants are only used when no watch output is configured
+template<class P>
+inline bool IQRouter::_Watch( Flit const * f ) const
+{
+  return P::generic && f->watch;
+}
+
 IQRouter::~IQRouter( )
 {
 
@@ -224,53 +325,59 @@ void IQRouter::ReadInputs( )
 }
 
 void IQRouter::_InternalStep( )
+{
+  _Step<IQRouterGenericPolicy>( );
+}
+
+template<class P>
+void IQRouter::_Step( )
 {
   if(!_active) {
     return;
   }
 
-  _InputQueuing( );
+  _InputQueuing<P>( );
   bool activity = !_proc_credits.empty();
 
   if(!_route_vcs.empty())
-    _RouteEvaluate( );
+    _RouteEvaluate<P>( );
   if(_vc_allocator) {
     _vc_allocator->Clear();
     if(!_vc_alloc_vcs.empty())
-      _VCAllocEvaluate( );
+      _VCAllocEvaluate<P>( );
   }
-  if(_hold_switch_for_packet) {
+  if(_HoldSwitch<P>()) {
     if(!_sw_hold_vcs.empty())
-      _SWHoldEvaluate( );
+      _SWHoldEvaluate<P>( );
   }
   _sw_allocator->Clear();
   if(_spec_sw_allocator)
     _spec_sw_allocator->Clear();
   if(!_sw_alloc_vcs.empty())
-    _SWAllocEvaluate( );
+    _SWAllocEvaluate<P>( );
   if(!_crossbar_flits.empty())
-    _SwitchEvaluate( );
+    _SwitchEvaluate<P>( );
 
   if(!_route_vcs.empty()) {
-    _RouteUpdate( );
+    _RouteUpdate<P>( );
     activity = activity || !_route_vcs.empty();
   }
   if(!_vc_alloc_vcs.empty()) {
-    _VCAllocUpdate( );
+    _VCAllocUpdate<P>( );
     activity = activity || !_vc_alloc_vcs.empty();
   }
-  if(_hold_switch_for_packet) {
+  if(_HoldSwitch<P>()) {
     if(!_sw_hold_vcs.empty()) {
-      _SWHoldUpdate( );
+      _SWHoldUpdate<P>( );
       activity = activity || !_sw_hold_vcs.empty();
     }
   }
   if(!_sw_alloc_vcs.empty()) {
-    _SWAllocUpdate( );
+    _SWAllocUpdate<P>( );
     activity = activity || !_sw_alloc_vcs.empty();
   }
   if(!_crossbar_flits.empty()) {
-    _SwitchUpdate( );
+    _SwitchUpdate<P>( );
     activity = activity || !_crossbar_flits.empty();
   }
 
@@ -288,6 +395,27 @@ void IQRouter::WriteOutputs( )
   _SendCredits( );
 }
 
+// an inactive router only needs to be evaluated again once a flit or credit
+// arrives; with a fractional internal speedup, skipped cycles would shift
+// the phase of the internal steps, so such routers never go to sleep
+bool IQRouter::Idle( ) const
+{
+  if(_active || (_internal_speedup != floor(_internal_speedup))) {
+    return false;
+  }
+  for(int output = 0; output < _outputs; ++output) {
+    if(!_output_buffer[output].empty()) {
+      return false;
+    }
+  }
+  for(int input = 0; input < _inputs; ++input) {
+    if(!_credit_buffer[input].empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 
 //------------------------------------------------------------------------------
 // read inputs
@@ -310,7 +438,8 @@ bool IQRouter::_ReceiveFlits( )
 		   << " from channel at input " << input
 		   << "." << endl;
       }
-      _in_queue_flits.insert(make_pair(input, f));
+      _in_queue_flits[input] = f;
+      _in_queue_mask[input / 64] |= 1ULL << (input % 64);
       activity = true;
     }
   }
@@ -336,16 +465,17 @@ bool IQRouter::_ReceiveCredits( )
 // input queuing
 //------------------------------------------------------------------------------
 
+template<class P>
 void IQRouter::_InputQueuing( )
 {
-  for(map<int, Flit *>::const_iterator iter = _in_queue_flits.begin();
-      iter != _in_queue_flits.end();
-      ++iter) {
+  for(int input = first_set_bit(&_in_queue_mask[0], _inputs, 0);
+      input >= 0;
+      input = first_set_bit(&_in_queue_mask[0], _inputs, 0)) {
 
-    int const input = iter->first;
     assert((input >= 0) && (input < _inputs));
+    _in_queue_mask[input / 64] &= ~(1ULL << (input % 64));
 
-    Flit * const f = iter->second;
+    Flit * const f = _in_queue_flits[input];
     assert(f);
 
     int const vc = f->vc;
@@ -353,7 +483,7 @@ void IQRouter::_InputQueuing( )
 
     Buffer * const cur_buf = _buf[input];
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Adding flit " << f->id
 		 << " to VC " << vc
@@ -381,43 +511,38 @@ void IQRouter::_InputQueuing( )
       assert(cur_buf->GetOccupancy(vc) == 1);
       assert(f->head);
       assert(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] != vc);
-      if(_routing_delay) {
+      if(!_Lookahead<P>()) {
 	cur_buf->SetState(vc, VC::routing);
-	_route_vcs.push_back(make_pair(-1, make_pair(input, vc)));
+	_route_vcs.push_back(input, vc);
       } else {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Using precomputed lookahead routing information for VC " << vc
 		     << " at input " << input
 		     << " (front: " << f->id
 		     << ")." << endl;
 	}
-	cur_buf->SetRouteSet(vc, &f->la_route_set);
+	cur_buf->SetRouteSet(vc, &f->cold().la_route_set);
 	cur_buf->SetState(vc, VC::vc_alloc);
-	if(_speculative) {
-	  _sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-							  -1)));
+	if(_Speculative<P>()) {
+	  _sw_alloc_vcs.push_back(input, vc);
 	}
 	if(_vc_allocator) {
-	  _vc_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), 
-							  -1)));
+	  _vc_alloc_vcs.push_back(input, vc);
 	}
-	if(_noq) {
-	  _UpdateNOQ(input, vc, f);
+	if(_NOQ<P>()) {
+	  _UpdateNOQ<P>(input, vc, f);
 	}
       }
     } else if((cur_buf->GetState(vc) == VC::active) &&
 	      (cur_buf->FrontFlit(vc) == f)) {
       if(_switch_hold_vc[input*_input_speedup + vc%_input_speedup] == vc) {
-	_sw_hold_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc),
-						       -1)));
+	_sw_hold_vcs.push_back(input, vc);
       } else {
-	_sw_alloc_vcs.push_back(make_pair(-1, make_pair(make_pair(input, vc), 
-							-1)));
+	_sw_alloc_vcs.push_back(input, vc);
       }
     }
   }
-  _in_queue_flits.clear();
 
   while(!_proc_credits.empty()) {
 
@@ -437,8 +562,7 @@ void IQRouter::_InputQueuing( )
     BufferState * const dest_buf = _next_buf[output];
     
 #ifdef TRACK_FLOWS
-    for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-      int const vc = *iter;
+    for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
       assert(!_outstanding_classes[output][vc].empty());
       int cl = _outstanding_classes[output][vc].front();
       _outstanding_classes[output][vc].pop();
@@ -458,23 +582,22 @@ void IQRouter::_InputQueuing( )
 // routing
 //------------------------------------------------------------------------------
 
+template<class P>
 void IQRouter::_RouteEvaluate( )
 {
-  assert(_routing_delay);
+  assert(!_Lookahead<P>());
 
-  for(deque<pair<int, pair<int, int> > >::iterator iter = _route_vcs.begin();
-      iter != _route_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _route_vcs.size(); ++n) {
     
-    int const time = iter->first;
+    int const time = _route_vcs.time(n);
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _routing_delay - 1;
+    _route_vcs.time(n) = GetSimTime() + _routing_delay - 1;
     
-    int const input = iter->second.first;
+    int const input = _route_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.second;
+    int const vc = _route_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
 
     Buffer const * const cur_buf = _buf[input];
@@ -486,7 +609,7 @@ void IQRouter::_RouteEvaluate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Beginning routing for VC " << vc
 		 << " at input " << input
@@ -496,23 +619,22 @@ void IQRouter::_RouteEvaluate( )
   }    
 }
 
+template<class P>
 void IQRouter::_RouteUpdate( )
 {
-  assert(_routing_delay);
+  assert(!_Lookahead<P>());
 
   while(!_route_vcs.empty()) {
 
-    pair<int, pair<int, int> > const & item = _route_vcs.front();
-
-    int const time = item.first;
+    int const time = _route_vcs.time(0);
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first;
+    int const input = _route_vcs.input(0);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.second;
+    int const vc = _route_vcs.vc(0);
     assert((vc >= 0) && (vc < _vcs));
     
     Buffer * const cur_buf = _buf[input];
@@ -524,7 +646,7 @@ void IQRouter::_RouteUpdate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed routing for VC " << vc
 		 << " at input " << input
@@ -534,11 +656,11 @@ void IQRouter::_RouteUpdate( )
 
     cur_buf->Route(vc, _rf, this, f, input);
     cur_buf->SetState(vc, VC::vc_alloc);
-    if(_speculative) {
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+    if(_Speculative<P>()) {
+      _sw_alloc_vcs.push_back(input, vc);
     }
     if(_vc_allocator) {
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second, -1)));
+      _vc_alloc_vcs.push_back(input, vc);
     }
     // NOTE: No need to handle NOQ here, as it requires lookahead routing!
     _route_vcs.pop_front();
@@ -550,27 +672,26 @@ void IQRouter::_RouteUpdate( )
 // VC allocation
 //------------------------------------------------------------------------------
 
+template<class P>
 void IQRouter::_VCAllocEvaluate( )
 {
   assert(_vc_allocator);
 
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-      iter != _vc_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _vc_alloc_vcs.size(); ++n) {
 
-    int const time = iter->first;
+    int const time = _vc_alloc_vcs.time(n);
     if(time >= 0) {
       break;
     }
 
-    int const input = iter->second.first.first;
+    int const input = _vc_alloc_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _vc_alloc_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
 
-    assert(iter->second.second == -1);
+    assert(_vc_alloc_vcs.output(n) == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -581,7 +702,7 @@ void IQRouter::_VCAllocEvaluate( )
     assert(f->vc == vc);
     assert(f->head);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning VC allocation for VC " << vc
 		 << " at input " << input
@@ -593,15 +714,15 @@ void IQRouter::_VCAllocEvaluate( )
     assert(route_set);
 
     int const out_priority = cur_buf->GetPriority(vc);
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet::ElementList const & setlist = route_set->GetSet();
 
     bool elig = false;
     bool cred = false;
     bool reserved = false;
 
-    assert(!_noq || (setlist.size() == 1));
+    assert(!_NOQ<P>() || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::ElementList::const_iterator iset = setlist.begin();
 	iset != setlist.end();
 	++iset) {
 
@@ -613,8 +734,8 @@ void IQRouter::_VCAllocEvaluate( )
       int vc_start;
       int vc_end;
       
-      if(_noq && _noq_next_output_port[input][vc] >= 0) {
-	assert(!_routing_delay);
+      if(_NOQ<P>() && _noq_next_output_port[input][vc] >= 0) {
+	assert(_Lookahead<P>());
 	vc_start = _noq_next_vc_start[input][vc];
 	vc_end = _noq_next_vc_end[input][vc];
       } else {
@@ -641,7 +762,7 @@ void IQRouter::_VCAllocEvaluate( )
 	// actual packet priorities, which is reflected in "out_priority".
 	
 	if(!dest_buf->IsAvailableFor(out_vc)) {
-	  if(f->watch) {
+	  if(_Watch<P>(f)) {
 	    int const use_input_and_vc = dest_buf->UsedBy(out_vc);
 	    int const use_input = use_input_and_vc / _vcs;
 	    int const use_vc = use_input_and_vc % _vcs;
@@ -660,8 +781,8 @@ void IQRouter::_VCAllocEvaluate( )
 	  }
 	} else {
 	  elig = true;
-	  if(_vc_busy_when_full && dest_buf->IsFullFor(out_vc)) {
-	    if(f->watch)
+	  if(_VCBusyWhenFull<P>() && dest_buf->IsFullFor(out_vc)) {
+	    if(_Watch<P>(f))
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "  VC " << out_vc 
 			 << " at output " << out_port 
@@ -669,7 +790,7 @@ void IQRouter::_VCAllocEvaluate( )
 	    reserved |= !dest_buf->IsFull();
 	  } else {
 	    cred = true;
-	    if(f->watch){
+	    if(_Watch<P>(f)){
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "  Requesting VC " << out_vc
 			 << " at output " << out_port 
@@ -687,9 +808,9 @@ void IQRouter::_VCAllocEvaluate( )
       }
     }
     if(!elig) {
-      iter->second.second = STALL_BUFFER_BUSY;
-    } else if(_vc_busy_when_full && !cred) {
-      iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+      _vc_alloc_vcs.output(n) = STALL_BUFFER_BUSY;
+    } else if(_VCBusyWhenFull<P>() && !cred) {
+      _vc_alloc_vcs.output(n) = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
     }
   }
 
@@ -705,26 +826,24 @@ void IQRouter::_VCAllocEvaluate( )
     _vc_allocator->PrintGrants( gWatchOut );
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-      iter != _vc_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _vc_alloc_vcs.size(); ++n) {
 
-    int const time = iter->first;
+    int const time = _vc_alloc_vcs.time(n);
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _vc_alloc_delay - 1;
+    _vc_alloc_vcs.time(n) = GetSimTime() + _vc_alloc_delay - 1;
 
-    int const input = iter->second.first.first;
+    int const input = _vc_alloc_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _vc_alloc_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
 
-    if(iter->second.second < -1) {
+    if(_vc_alloc_vcs.output(n) < -1) {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(_vc_alloc_vcs.output(n) == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -746,7 +865,7 @@ void IQRouter::_VCAllocEvaluate( )
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "Assigning VC " << match_vc
 		   << " at output " << match_output 
@@ -755,18 +874,18 @@ void IQRouter::_VCAllocEvaluate( )
 		   << "." << endl;
       }
 
-      iter->second.second = output_and_vc;
+      _vc_alloc_vcs.output(n) = output_and_vc;
 
     } else {
 
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "VC allocation failed for VC " << vc
 		   << " at input " << input
 		   << "." << endl;
       }
       
-      iter->second.second = STALL_BUFFER_CONFLICT;
+      _vc_alloc_vcs.output(n) = STALL_BUFFER_CONFLICT;
 
     }
   }
@@ -775,19 +894,17 @@ void IQRouter::_VCAllocEvaluate( )
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _vc_alloc_vcs.begin();
-      iter != _vc_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _vc_alloc_vcs.size(); ++n) {
     
-    int const time = iter->first;
+    int const time = _vc_alloc_vcs.time(n);
     assert(time >= 0);
     if(GetSimTime() < time) {
       break;
     }
     
-    assert(iter->second.second != -1);
+    assert(_vc_alloc_vcs.output(n) != -1);
 
-    int const output_and_vc = iter->second.second;
+    int const output_and_vc = _vc_alloc_vcs.output(n);
     
     if(output_and_vc >= 0) {
       
@@ -798,9 +915,9 @@ void IQRouter::_VCAllocEvaluate( )
       
       BufferState const * const dest_buf = _next_buf[match_output];
       
-      int const input = iter->second.first.first;
+      int const input = _vc_alloc_vcs.input(n);
       assert((input >= 0) && (input < _inputs));
-      int const vc = iter->second.first.second;
+      int const vc = _vc_alloc_vcs.vc(n);
       assert((vc >= 0) && (vc < _vcs));
       
       Buffer const * const cur_buf = _buf[input];
@@ -813,7 +930,7 @@ void IQRouter::_VCAllocEvaluate( )
       assert(f->head);
       
       if(!dest_buf->IsAvailableFor(match_vc)) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Discarding previously generated grant for VC " << vc
 		     << " at input " << input
@@ -821,9 +938,9 @@ void IQRouter::_VCAllocEvaluate( )
 		     << " at output " << match_output
 		     << " is no longer available." << endl;
 	}
-	iter->second.second = STALL_BUFFER_BUSY;
-      } else if(_vc_busy_when_full && dest_buf->IsFullFor(match_vc)) {
-	if(f->watch) {
+	_vc_alloc_vcs.output(n) = STALL_BUFFER_BUSY;
+      } else if(_VCBusyWhenFull<P>() && dest_buf->IsFullFor(match_vc)) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Discarding previously generated grant for VC " << vc
 		     << " at input " << input
@@ -831,32 +948,31 @@ void IQRouter::_VCAllocEvaluate( )
 		     << " at output " << match_output
 		     << " has become full." << endl;
 	}
-	iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+	_vc_alloc_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       }
     }
   }
 }
 
+template<class P>
 void IQRouter::_VCAllocUpdate( )
 {
   assert(_vc_allocator);
 
   while(!_vc_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _vc_alloc_vcs.front();
-
-    int const time = item.first;
+    int const time = _vc_alloc_vcs.time(0);
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = _vc_alloc_vcs.input(0);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _vc_alloc_vcs.vc(0);
     assert((vc >= 0) && (vc < _vcs));
     
-    assert(item.second.second != -1);
+    assert(_vc_alloc_vcs.output(0) != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -867,7 +983,7 @@ void IQRouter::_VCAllocUpdate( )
     assert(f->vc == vc);
     assert(f->head);
     
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed VC allocation for VC " << vc
 		 << " at input " << input
@@ -875,7 +991,7 @@ void IQRouter::_VCAllocUpdate( )
 		 << ")." << endl;
     }
     
-    int const output_and_vc = item.second.second;
+    int const output_and_vc = _vc_alloc_vcs.output(0);
     
     if(output_and_vc >= 0) {
       
@@ -884,7 +1000,7 @@ void IQRouter::_VCAllocUpdate( )
       int const match_vc = output_and_vc % _vcs;
       assert((match_vc >= 0) && (match_vc < _vcs));
       
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Acquiring assigned VC " << match_vc
 		   << " at output " << match_output
@@ -898,11 +1014,11 @@ void IQRouter::_VCAllocUpdate( )
 	
       cur_buf->SetOutput(vc, match_output, match_vc);
       cur_buf->SetState(vc, VC::active);
-      if(!_speculative) {
-	_sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      if(!_Speculative<P>()) {
+	_sw_alloc_vcs.push_back(input, vc);
       }
     } else {
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  No output VC allocated." << endl;
       }
@@ -917,7 +1033,7 @@ void IQRouter::_VCAllocUpdate( )
       }
 #endif
 
-      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _vc_alloc_vcs.push_back(input, vc);
     }
     _vc_alloc_vcs.pop_front();
   }
@@ -928,26 +1044,25 @@ void IQRouter::_VCAllocUpdate( )
 // switch holding
 //------------------------------------------------------------------------------
 
+template<class P>
 void IQRouter::_SWHoldEvaluate( )
 {
-  assert(_hold_switch_for_packet);
+  assert(_HoldSwitch<P>());
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_hold_vcs.begin();
-      iter != _sw_hold_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _sw_hold_vcs.size(); ++n) {
     
-    int const time = iter->first;
+    int const time = _sw_hold_vcs.time(n);
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime();
+    _sw_hold_vcs.time(n) = GetSimTime();
     
-    int const input = iter->second.first.first;
+    int const input = _sw_hold_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_hold_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
     
-    assert(iter->second.second == -1);
+    assert(_sw_hold_vcs.output(n) == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -957,7 +1072,7 @@ void IQRouter::_SWHoldEvaluate( )
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning held switch allocation for VC " << vc
 		 << " at input " << input
@@ -979,7 +1094,7 @@ void IQRouter::_SWHoldEvaluate( )
     BufferState const * const dest_buf = _next_buf[match_port];
     
     if(dest_buf->IsFullFor(match_vc)) {
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Unable to reuse held connection from input " << input
 		   << "." << (expanded_input % _input_speedup)
@@ -987,9 +1102,9 @@ void IQRouter::_SWHoldEvaluate( )
 		   << "." << (expanded_output % _output_speedup)
 		   << ": No credit available." << endl;
       }
-      iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+      _sw_hold_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
     } else {
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Reusing held connection from input " << input
 		   << "." << (expanded_input % _input_speedup)
@@ -997,31 +1112,30 @@ void IQRouter::_SWHoldEvaluate( )
 		   << "." << (expanded_output % _output_speedup)
 		   << "." << endl;
       }
-      iter->second.second = expanded_output;
+      _sw_hold_vcs.output(n) = expanded_output;
     }
   }
 }
 
+template<class P>
 void IQRouter::_SWHoldUpdate( )
 {
-  assert(_hold_switch_for_packet);
+  assert(_HoldSwitch<P>());
 
   while(!_sw_hold_vcs.empty()) {
     
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_hold_vcs.front();
-    
-    int const time = item.first;
+    int const time = _sw_hold_vcs.time(0);
     if(time < 0) {
       break;
     }
     assert(GetSimTime() == time);
     
-    int const input = item.second.first.first;
+    int const input = _sw_hold_vcs.input(0);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _sw_hold_vcs.vc(0);
     assert((vc >= 0) && (vc < _vcs));
     
-    assert(item.second.second != -1);
+    assert(_sw_hold_vcs.output(0) != -1);
 
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
@@ -1031,7 +1145,7 @@ void IQRouter::_SWHoldUpdate( )
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed held switch allocation for VC " << vc
 		 << " at input " << input
@@ -1042,7 +1156,7 @@ void IQRouter::_SWHoldUpdate( )
     int const expanded_input = input * _input_speedup + vc % _input_speedup;
     assert(_switch_hold_vc[expanded_input] == vc);
     
-    int const expanded_output = item.second.second;
+    int const expanded_output = _sw_hold_vcs.output(0);
     
     if(expanded_output >= 0 && ( _output_buffer_size==-1 || _output_buffer[expanded_output/_output_speedup].size()<size_t(_output_buffer_size))) {
       
@@ -1058,7 +1172,7 @@ void IQRouter::_SWHoldUpdate( )
       
       BufferState * const dest_buf = _next_buf[output];
       
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Scheduling switch connection from input " << input
 		   << "." << (vc % _input_speedup)
@@ -1079,12 +1193,12 @@ void IQRouter::_SWHoldUpdate( )
       f->hops++;
       f->vc = match_vc;
       
-      if(!_routing_delay && f->head) {
+      if(_Lookahead<P>() && f->head) {
 	const FlitChannel * channel = _output_channels[output];
 	const Router * router = channel->GetSink();
 	if(router) {
-	  if(_noq) {
-	    if(f->watch) {
+	  if(_NOQ<P>()) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << " (NOQ)." << endl;
@@ -1098,19 +1212,19 @@ void IQRouter::_SWHoldUpdate( )
 	    int next_vc_end = _noq_next_vc_end[input][vc];
 	    assert(next_vc_end >= 0 && next_vc_end < _vcs);
 	    _noq_next_vc_end[input][vc] = -1;
-	    f->la_route_set.Clear();
-	    f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+	    f->cold().la_route_set.Clear();
+	    f->cold().la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
 	  } else {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << "." << endl;
 	    }
 	    int in_channel = channel->GetSinkPort();
-	    _rf(router, f, in_channel, &f->la_route_set, false);
+	    _rf(router, f, in_channel, &f->cold().la_route_set, false);
 	  }
 	} else {
-	  f->la_route_set.Clear();
+	  f->cold().la_route_set.Clear();
 	}
       }
 
@@ -1121,15 +1235,16 @@ void IQRouter::_SWHoldUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(expanded_input, -1, expanded_output, f);
       
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+	_out_queue_credits[input] = Credit::New();
+	_out_queue_mask[input / 64] |= 1ULL << (input % 64);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->AddVC(vc);
       
       if(cur_buf->Empty(vc)) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Cancelling held connection from input " << input
 		     << "." << (expanded_input % _input_speedup)
@@ -1149,7 +1264,7 @@ void IQRouter::_SWHoldUpdate( )
 	assert(nf->vc == vc);
 	if(f->tail) {
 	  assert(nf->head);
-	  if(f->watch) {
+	  if(_Watch<P>(f)) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "  Cancelling held connection from input " << input
 		       << "." << (expanded_input % _input_speedup)
@@ -1160,34 +1275,31 @@ void IQRouter::_SWHoldUpdate( )
 	  _switch_hold_vc[expanded_input] = -1;
 	  _switch_hold_in[expanded_input] = -1;
 	  _switch_hold_out[expanded_output] = -1;
-	  if(_routing_delay) {
+	  if(!_Lookahead<P>()) {
 	    cur_buf->SetState(vc, VC::routing);
-	    _route_vcs.push_back(make_pair(-1, item.second.first));
+	    _route_vcs.push_back(input, vc);
 	  } else {
-	    if(nf->watch) {
+	    if(_Watch<P>(nf)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Using precomputed lookahead routing information for VC " << vc
 			 << " at input " << input
 			 << " (front: " << nf->id
 			 << ")." << endl;
 	    }
-	    cur_buf->SetRouteSet(vc, &nf->la_route_set);
+	    cur_buf->SetRouteSet(vc, &nf->cold().la_route_set);
 	    cur_buf->SetState(vc, VC::vc_alloc);
-	    if(_speculative) {
-	      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							      -1)));
+	    if(_Speculative<P>()) {
+	      _sw_alloc_vcs.push_back(input, vc);
 	    }
 	    if(_vc_allocator) {
-	      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							      -1)));
+	      _vc_alloc_vcs.push_back(input, vc);
 	    }
-	    if(_noq) {
-	      _UpdateNOQ(input, vc, nf);
+	    if(_NOQ<P>()) {
+	      _UpdateNOQ<P>(input, vc, nf);
 	    }
 	  }
 	} else {
-	  _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							 -1)));
+	  _sw_hold_vcs.push_back(input, vc);
 	}
       }
     } else {
@@ -1198,7 +1310,7 @@ void IQRouter::_SWHoldUpdate( )
       int const held_expanded_output = _switch_hold_in[expanded_input];
       assert(held_expanded_output >= 0);
       
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Cancelling held connection from input " << input
 		   << "." << (expanded_input % _input_speedup)
@@ -1209,8 +1321,7 @@ void IQRouter::_SWHoldUpdate( )
       _switch_hold_vc[expanded_input] = -1;
       _switch_hold_in[expanded_input] = -1;
       _switch_hold_out[held_expanded_output] = -1;
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-						      -1)));
+      _sw_alloc_vcs.push_back(input, vc);
     }
     _sw_hold_vcs.pop_front();
   }
@@ -1221,6 +1332,7 @@ void IQRouter::_SWHoldUpdate( )
 // switch allocation
 //------------------------------------------------------------------------------
 
+template<class P>
 bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
 {
   assert(input >= 0 && input < _inputs);
@@ -1237,7 +1349,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   Buffer const * const cur_buf = _buf[input];
   assert(!cur_buf->Empty(vc));
   assert((cur_buf->GetState(vc) == VC::active) || 
-	 (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	 (_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)));
   
   Flit const * const f = cur_buf->FrontFlit(vc);
   assert(f);
@@ -1249,7 +1361,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
     Allocator * allocator = _sw_allocator;
     int prio = cur_buf->GetPriority(vc);
     
-    if(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+    if(_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)) {
       if(_spec_sw_allocator) {
 	allocator = _spec_sw_allocator;
       } else {
@@ -1263,7 +1375,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
     if(allocator->ReadRequest(req, expanded_input, expanded_output)) {
       if(RoundRobinArbiter::Supersedes(vc, prio, req.label, req.in_pri, 
 				       _sw_rr_offset[expanded_input], _vcs)) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Replacing earlier request from VC " << req.label
 		     << " for output " << output 
@@ -1279,7 +1391,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
 	allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
 	return true;
       }
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Output " << output
 		   << "." << (expanded_output % _output_speedup)
@@ -1290,7 +1402,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
       }
       return false;
     }
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "  Requesting output " << output
 		 << "." << (expanded_output % _output_speedup)
@@ -1303,7 +1415,7 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
     allocator->AddRequest(expanded_input, expanded_output, vc, prio, prio);
     return true;
   }
-  if(f->watch) {
+  if(_Watch<P>(f)) {
     *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 	       << "  Ignoring output " << output
 	       << "." << (expanded_output % _output_speedup)
@@ -1324,38 +1436,37 @@ bool IQRouter::_SWAllocAddReq(int input, int vc, int output)
   return false;
 }
 
+template<class P>
 void IQRouter::_SWAllocEvaluate( )
 {
   bool watched = false;
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-      iter != _sw_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _sw_alloc_vcs.size(); ++n) {
 
-    int const time = iter->first;
+    int const time = _sw_alloc_vcs.time(n);
     if(time >= 0) {
       break;
     }
 
-    int const input = iter->second.first.first;
+    int const input = _sw_alloc_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_alloc_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
     
-    assert(iter->second.second == -1);
+    assert(_sw_alloc_vcs.output(n) == -1);
 
     assert(_switch_hold_vc[input * _input_speedup + vc % _input_speedup] != vc);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | " 
 		 << "Beginning switch allocation for VC " << vc
 		 << " at input " << input
@@ -1373,20 +1484,20 @@ void IQRouter::_SWAllocEvaluate( )
       BufferState const * const dest_buf = _next_buf[dest_output];
       
       if(dest_buf->IsFullFor(dest_vc) || ( _output_buffer_size!=-1  && _output_buffer[dest_output].size()>=(size_t)(_output_buffer_size))) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  VC " << dest_vc 
 		     << " at output " << dest_output 
 		     << " is full." << endl;
 	}
-	iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+	_sw_alloc_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
 	continue;
       }
-      bool const requested = _SWAllocAddReq(input, vc, dest_output);
-      watched |= requested && f->watch;
+      bool const requested = _SWAllocAddReq<P>(input, vc, dest_output);
+      watched |= requested && _Watch<P>(f);
       continue;
     }
-    assert(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc));
+    assert(_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc));
     assert(f->head);
       
     // The following models the speculative VC allocation aspects of the 
@@ -1397,11 +1508,11 @@ void IQRouter::_SWAllocEvaluate( )
     OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
     assert(route_set);
     
-    set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+    OutputSet::ElementList const & setlist = route_set->GetSet();
     
-    assert(!_noq || (setlist.size() == 1));
+    assert(!_NOQ<P>() || (setlist.size() == 1));
 
-    for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+    for(OutputSet::ElementList::const_iterator iset = setlist.begin();
 	iset != setlist.end();
 	++iset) {
       
@@ -1424,8 +1535,8 @@ void IQRouter::_SWAllocEvaluate( )
 	int vc_start;
 	int vc_end;
 	
-	if(_noq && _noq_next_output_port[input][vc] >= 0) {
-	  assert(!_routing_delay);
+	if(_NOQ<P>() && _noq_next_output_port[input][vc] >= 0) {
+	  assert(_Lookahead<P>());
 	  vc_start = _noq_next_vc_start[input][vc];
 	  vc_end = _noq_next_vc_end[input][vc];
 	} else {
@@ -1450,22 +1561,22 @@ void IQRouter::_SWAllocEvaluate( )
       }
       
       if(_spec_check_elig && !elig) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Output " << dest_output 
 		     << " has no suitable VCs available." << endl;
 	}
-	iter->second.second = STALL_BUFFER_BUSY;
+	_sw_alloc_vcs.output(n) = STALL_BUFFER_BUSY;
       } else if(_spec_check_cred && !cred) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  All suitable VCs at output " << dest_output 
 		     << " are full." << endl;
 	}
-	iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+	_sw_alloc_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
       } else {
-	bool const requested = _SWAllocAddReq(input, vc, dest_output);
-	watched |= requested && f->watch;
+	bool const requested = _SWAllocAddReq<P>(input, vc, dest_output);
+	watched |= requested && _Watch<P>(f);
       }
     }
   }
@@ -1492,31 +1603,29 @@ void IQRouter::_SWAllocEvaluate( )
     }
   }
   
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-      iter != _sw_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _sw_alloc_vcs.size(); ++n) {
 
-    int const time = iter->first;
+    int const time = _sw_alloc_vcs.time(n);
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _sw_alloc_delay - 1;
+    _sw_alloc_vcs.time(n) = GetSimTime() + _sw_alloc_delay - 1;
 
-    int const input = iter->second.first.first;
+    int const input = _sw_alloc_vcs.input(n);
     assert((input >= 0) && (input < _inputs));
-    int const vc = iter->second.first.second;
+    int const vc = _sw_alloc_vcs.vc(n);
     assert((vc >= 0) && (vc < _vcs));
 
-    if(iter->second.second < -1) {
+    if(_sw_alloc_vcs.output(n) < -1) {
       continue;
     }
 
-    assert(iter->second.second == -1);
+    assert(_sw_alloc_vcs.output(n) == -1);
 
     Buffer const * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) || 
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit const * const f = cur_buf->FrontFlit(vc);
     assert(f);
@@ -1530,7 +1639,7 @@ void IQRouter::_SWAllocEvaluate( )
       assert((expanded_output % _output_speedup) == (input % _output_speedup));
       int const granted_vc = _sw_allocator->ReadRequest(expanded_input, expanded_output);
       if(granted_vc == vc) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Assigning output " << (expanded_output / _output_speedup)
 		     << "." << (expanded_output % _output_speedup)
@@ -1540,15 +1649,15 @@ void IQRouter::_SWAllocEvaluate( )
 		     << "." << endl;
 	}
 	_sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-	iter->second.second = expanded_output;
+	_sw_alloc_vcs.output(n) = expanded_output;
       } else {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Switch allocation failed for VC " << vc
 		     << " at input " << input
 		     << ": Granted to VC " << granted_vc << "." << endl;
 	}
-	iter->second.second = STALL_CROSSBAR_CONFLICT;
+	_sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
       }
     } else if(_spec_sw_allocator) {
       expanded_output = _spec_sw_allocator->OutputAssigned(expanded_input);
@@ -1556,7 +1665,7 @@ void IQRouter::_SWAllocEvaluate( )
 	assert((expanded_output % _output_speedup) == (input % _output_speedup));
 	if(_spec_mask_by_reqs && 
 	   _sw_allocator->OutputHasRequests(expanded_output)) {
-	  if(f->watch) {
+	  if(_Watch<P>(f)) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "Discarding speculative grant for VC " << vc
 		       << " at input " << input
@@ -1565,10 +1674,10 @@ void IQRouter::_SWAllocEvaluate( )
 		       << "." << (expanded_output % _output_speedup)
 		       << " has non-speculative requests." << endl;
 	  }
-	  iter->second.second = STALL_CROSSBAR_CONFLICT;
+	  _sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
 	} else if(!_spec_mask_by_reqs &&
 		  (_sw_allocator->InputAssigned(expanded_output) >= 0)) {
-	  if(f->watch) {
+	  if(_Watch<P>(f)) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "Discarding speculative grant for VC " << vc
 		       << " at input " << input
@@ -1577,12 +1686,12 @@ void IQRouter::_SWAllocEvaluate( )
 		       << "." << (expanded_output % _output_speedup)
 		       << " has a non-speculative grant." << endl;
 	  }
-	  iter->second.second = STALL_CROSSBAR_CONFLICT;
+	  _sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
 	} else {
 	  int const granted_vc = _spec_sw_allocator->ReadRequest(expanded_input, 
 								 expanded_output);
 	  if(granted_vc == vc) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Assigning output " << (expanded_output / _output_speedup)
 			 << "." << (expanded_output % _output_speedup)
@@ -1592,60 +1701,58 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << endl;
 	    }
 	    _sw_rr_offset[expanded_input] = (vc + _input_speedup) % _vcs;
-	    iter->second.second = expanded_output;
+	    _sw_alloc_vcs.output(n) = expanded_output;
 	  } else {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Switch allocation failed for VC " << vc
 			 << " at input " << input
 			 << ": Granted to VC " << granted_vc << "." << endl;
 	    }
-	    iter->second.second = STALL_CROSSBAR_CONFLICT;
+	    _sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
 	  }
 	}
       } else {
 
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Switch allocation failed for VC " << vc
 		     << " at input " << input
 		     << ": No output granted." << endl;
 	}
 	
-	iter->second.second = STALL_CROSSBAR_CONFLICT;
+	_sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
 
       }
     } else {
       
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "Switch allocation failed for VC " << vc
 		   << " at input " << input
 		   << ": No output granted." << endl;
       }
       
-      iter->second.second = STALL_CROSSBAR_CONFLICT;
+      _sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
       
     }
   }
   
-  if(!_speculative && (_sw_alloc_delay <= 1)) {
+  if(!_Speculative<P>() && (_sw_alloc_delay <= 1)) {
     return;
   }
 
-  for(deque<pair<int, pair<pair<int, int>, int> > >::iterator iter = _sw_alloc_vcs.begin();
-      iter != _sw_alloc_vcs.end();
-      ++iter) {
+  for(int n = 0; n < _sw_alloc_vcs.size(); ++n) {
 
-    int const time = iter->first;
+    int const time = _sw_alloc_vcs.time(n);
     assert(time >= 0);
     if(GetSimTime() < time) {
       break;
     }
 
-    assert(iter->second.second != -1);
+    assert(_sw_alloc_vcs.output(n) != -1);
 
-    int const expanded_output = iter->second.second;
+    int const expanded_output = _sw_alloc_vcs.output(n);
     
     if(expanded_output >= 0) {
       
@@ -1654,10 +1761,10 @@ void IQRouter::_SWAllocEvaluate( )
       
       BufferState const * const dest_buf = _next_buf[output];
       
-      int const input = iter->second.first.first;
+      int const input = _sw_alloc_vcs.input(n);
       assert((input >= 0) && (input < _inputs));
       assert((input % _output_speedup) == (expanded_output % _output_speedup));
-      int const vc = iter->second.first.second;
+      int const vc = _sw_alloc_vcs.vc(n);
       assert((vc >= 0) && (vc < _vcs));
       
       int const expanded_input = input * _input_speedup + vc % _input_speedup;
@@ -1666,7 +1773,7 @@ void IQRouter::_SWAllocEvaluate( )
       Buffer const * const cur_buf = _buf[input];
       assert(!cur_buf->Empty(vc));
       assert((cur_buf->GetState(vc) == VC::active) ||
-	     (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	     (_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)));
       
       Flit const * const f = cur_buf->FrontFlit(vc);
       assert(f);
@@ -1674,7 +1781,7 @@ void IQRouter::_SWAllocEvaluate( )
 
       if((_switch_hold_in[expanded_input] >= 0) ||
 	 (_switch_hold_out[expanded_output] >= 0)) {
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "Discarding grant from input " << input
 		     << "." << (vc % _input_speedup)
@@ -1693,8 +1800,8 @@ void IQRouter::_SWAllocEvaluate( )
 	  }
 	  *gWatchOut << "." << endl;
 	}
-	iter->second.second = STALL_CROSSBAR_CONFLICT;
-      } else if(_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)) {
+	_sw_alloc_vcs.output(n) = STALL_CROSSBAR_CONFLICT;
+      } else if(_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)) {
 
 	assert(f->head);
 
@@ -1705,7 +1812,7 @@ void IQRouter::_SWAllocEvaluate( )
 	  int const output_and_vc = _vc_allocator->OutputAssigned(input_and_vc);
 
 	  if(output_and_vc < 0) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
 			 << "." << (vc % _input_speedup)
@@ -1713,9 +1820,9 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << (expanded_output % _output_speedup)
 			 << " due to misspeculation." << endl;
 	    }
-	    iter->second.second = -1; // stall is counted in VC allocation path!
+	    _sw_alloc_vcs.output(n) = -1; // stall is counted in VC allocation path!
 	  } else if((output_and_vc / _vcs) != output) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
 			 << "." << (vc % _input_speedup)
@@ -1723,9 +1830,9 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << (expanded_output % _output_speedup)
 			 << " due to port mismatch between VC and switch allocator." << endl;
 	    }
-	    iter->second.second = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
+	    _sw_alloc_vcs.output(n) = STALL_BUFFER_CONFLICT; // count this case as if we had failed allocation
 	  } else if(dest_buf->IsFullFor((output_and_vc % _vcs))) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
 			 << "." << (vc % _input_speedup)
@@ -1733,7 +1840,7 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << (expanded_output % _output_speedup)
 			 << " due to lack of credit." << endl;
 	    }
-	    iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+	    _sw_alloc_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
 	  }
 
 	} else { // VC allocation is piggybacked onto switch allocation
@@ -1741,15 +1848,15 @@ void IQRouter::_SWAllocEvaluate( )
 	  OutputSet const * const route_set = cur_buf->GetRouteSet(vc);
 	  assert(route_set);
 
-	  set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+	  OutputSet::ElementList const & setlist = route_set->GetSet();
 
 	  bool busy = true;
 	  bool full = true;
 	  bool reserved = false;
 
-	  assert(!_noq || (setlist.size() == 1));
+	  assert(!_NOQ<P>() || (setlist.size() == 1));
 
-	  for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+	  for(OutputSet::ElementList::const_iterator iset = setlist.begin();
 	      iset != setlist.end();
 	      ++iset) {
 	    if(iset->output_port == output) {
@@ -1757,8 +1864,8 @@ void IQRouter::_SWAllocEvaluate( )
 	      int vc_start;
 	      int vc_end;
 	      
-	      if(_noq && _noq_next_output_port[input][vc] >= 0) {
-		assert(!_routing_delay);
+	      if(_NOQ<P>() && _noq_next_output_port[input][vc] >= 0) {
+		assert(_Lookahead<P>());
 		vc_start = _noq_next_vc_start[input][vc];
 		vc_end = _noq_next_vc_end[input][vc];
 	      } else {
@@ -1788,7 +1895,7 @@ void IQRouter::_SWAllocEvaluate( )
 	  }
 
 	  if(busy) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
 			 << "." << (vc % _input_speedup)
@@ -1796,9 +1903,9 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << (expanded_output % _output_speedup)
 			 << " because no suitable output VC for piggyback allocation is available." << endl;
 	    }
-	    iter->second.second = STALL_BUFFER_BUSY;
+	    _sw_alloc_vcs.output(n) = STALL_BUFFER_BUSY;
 	  } else if(full) {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Discarding grant from input " << input
 			 << "." << (vc % _input_speedup)
@@ -1806,7 +1913,7 @@ void IQRouter::_SWAllocEvaluate( )
 			 << "." << (expanded_output % _output_speedup)
 			 << " because all suitable output VCs for piggyback allocation are full." << endl;
 	    }
-	    iter->second.second = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
+	    _sw_alloc_vcs.output(n) = reserved ? STALL_BUFFER_RESERVED : STALL_BUFFER_FULL;
 	  }
 
 	}
@@ -1818,7 +1925,7 @@ void IQRouter::_SWAllocEvaluate( )
 	assert((match_vc >= 0) && (match_vc < _vcs));
 
 	if(dest_buf->IsFullFor(match_vc)) {
-	  if(f->watch) {
+	  if(_Watch<P>(f)) {
 	    *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		       << "  Discarding grant from input " << input
 		       << "." << (vc % _input_speedup)
@@ -1826,40 +1933,39 @@ void IQRouter::_SWAllocEvaluate( )
 		       << "." << (expanded_output % _output_speedup)
 		       << " due to lack of credit." << endl;
 	  }
-	  iter->second.second = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
+	  _sw_alloc_vcs.output(n) = dest_buf->IsFull() ? STALL_BUFFER_FULL : STALL_BUFFER_RESERVED;
 	}
       }
     }
   }
 }
 
+template<class P>
 void IQRouter::_SWAllocUpdate( )
 {
   while(!_sw_alloc_vcs.empty()) {
 
-    pair<int, pair<pair<int, int>, int> > const & item = _sw_alloc_vcs.front();
-
-    int const time = item.first;
+    int const time = _sw_alloc_vcs.time(0);
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    int const input = item.second.first.first;
+    int const input = _sw_alloc_vcs.input(0);
     assert((input >= 0) && (input < _inputs));
-    int const vc = item.second.first.second;
+    int const vc = _sw_alloc_vcs.vc(0);
     assert((vc >= 0) && (vc < _vcs));
     
     Buffer * const cur_buf = _buf[input];
     assert(!cur_buf->Empty(vc));
     assert((cur_buf->GetState(vc) == VC::active) ||
-	   (_speculative && (cur_buf->GetState(vc) == VC::vc_alloc)));
+	   (_Speculative<P>() && (cur_buf->GetState(vc) == VC::vc_alloc)));
     
     Flit * const f = cur_buf->FrontFlit(vc);
     assert(f);
     assert(f->vc == vc);
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed switch allocation for VC " << vc
 		 << " at input " << input
@@ -1867,7 +1973,7 @@ void IQRouter::_SWAllocUpdate( )
 		 << ")." << endl;
     }
     
-    int const expanded_output = item.second.second;
+    int const expanded_output = _sw_alloc_vcs.output(0);
     
     if(expanded_output >= 0) {
       
@@ -1896,11 +2002,11 @@ void IQRouter::_SWAllocUpdate( )
 	int match_prio = numeric_limits<int>::min();
 
 	const OutputSet * route_set = cur_buf->GetRouteSet(vc);
-	set<OutputSet::sSetElement> const setlist = route_set->GetSet();
+	OutputSet::ElementList const & setlist = route_set->GetSet();
 	
-	assert(!_noq || (setlist.size() == 1));
+	assert(!_NOQ<P>() || (setlist.size() == 1));
 	
-	for(set<OutputSet::sSetElement>::const_iterator iset = setlist.begin();
+	for(OutputSet::ElementList::const_iterator iset = setlist.begin();
 	    iset != setlist.end();
 	    ++iset) {
 	  if(iset->output_port == output) {
@@ -1908,8 +2014,8 @@ void IQRouter::_SWAllocUpdate( )
 	    int vc_start;
 	    int vc_end;
 	    
-	    if(_noq && _noq_next_output_port[input][vc] >= 0) {
-	      assert(!_routing_delay);
+	    if(_NOQ<P>() && _noq_next_output_port[input][vc] >= 0) {
+	      assert(_Lookahead<P>());
 	      vc_start = _noq_next_vc_start[input][vc];
 	      vc_end = _noq_next_vc_end[input][vc];
 	    } else {
@@ -1946,7 +2052,7 @@ void IQRouter::_SWAllocUpdate( )
 	}
 	assert(match_vc >= 0);
 
-	if(f->watch) {
+	if(_Watch<P>(f)) {
 	  *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		     << "  Allocating VC " << match_vc
 		     << " at output " << output
@@ -1968,7 +2074,7 @@ void IQRouter::_SWAllocUpdate( )
       }
       assert((match_vc >= 0) && (match_vc < _vcs));
 
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  Scheduling switch connection from input " << input
 		   << "." << (vc % _input_speedup)
@@ -1989,12 +2095,12 @@ void IQRouter::_SWAllocUpdate( )
       f->hops++;
       f->vc = match_vc;
 
-      if(!_routing_delay && f->head) {
+      if(_Lookahead<P>() && f->head) {
 	const FlitChannel * channel = _output_channels[output];
 	const Router * router = channel->GetSink();
 	if(router) {
-	  if(_noq) {
-	    if(f->watch) {
+	  if(_NOQ<P>()) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << " (NOQ)." << endl;
@@ -2008,19 +2114,19 @@ void IQRouter::_SWAllocUpdate( )
 	    int next_vc_end = _noq_next_vc_end[input][vc];
 	    assert(next_vc_end >= 0 && next_vc_end < _vcs);
 	    _noq_next_vc_end[input][vc] = -1;
-	    f->la_route_set.Clear();
-	    f->la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
+	    f->cold().la_route_set.Clear();
+	    f->cold().la_route_set.AddRange(next_output_port, next_vc_start, next_vc_end);
 	  } else {
-	    if(f->watch) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Updating lookahead routing information for flit " << f->id
 			 << "." << endl;
 	    }
 	    int in_channel = channel->GetSinkPort();
-	    _rf(router, f, in_channel, &f->la_route_set, false);
+	    _rf(router, f, in_channel, &f->cold().la_route_set, false);
 	  }
 	} else {
-	  f->la_route_set.Clear();
+	  f->cold().la_route_set.Clear();
 	}
       }
 
@@ -2031,12 +2137,13 @@ void IQRouter::_SWAllocUpdate( )
 
       dest_buf->SendingFlit(f);
 
-      _crossbar_flits.push_back(make_pair(-1, make_pair(f, make_pair(expanded_input, expanded_output))));
+      _crossbar_flits.push_back(expanded_input, -1, expanded_output, f);
 
-      if(_out_queue_credits.count(input) == 0) {
-	_out_queue_credits.insert(make_pair(input, Credit::New()));
+      if(!_out_queue_credits[input]) {
+	_out_queue_credits[input] = Credit::New();
+	_out_queue_mask[input / 64] |= 1ULL << (input % 64);
       }
-      _out_queue_credits.find(input)->second->vc.insert(vc);
+      _out_queue_credits[input]->AddVC(vc);
 
       if(cur_buf->Empty(vc)) {
 	if(f->tail) {
@@ -2048,34 +2155,32 @@ void IQRouter::_SWAllocUpdate( )
 	assert(nf->vc == vc);
 	if(f->tail) {
 	  assert(nf->head);
-	  if(_routing_delay) {
+	  if(!_Lookahead<P>()) {
 	    cur_buf->SetState(vc, VC::routing);
-	    _route_vcs.push_back(make_pair(-1, item.second.first));
+	    _route_vcs.push_back(input, vc);
 	  } else {
-	    if(nf->watch) {
+	    if(_Watch<P>(nf)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Using precomputed lookahead routing information for VC " << vc
 			 << " at input " << input
 			 << " (front: " << nf->id
 			 << ")." << endl;
 	    }
-	    cur_buf->SetRouteSet(vc, &nf->la_route_set);
+	    cur_buf->SetRouteSet(vc, &nf->cold().la_route_set);
 	    cur_buf->SetState(vc, VC::vc_alloc);
-	    if(_speculative) {
-	      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							      -1)));
+	    if(_Speculative<P>()) {
+	      _sw_alloc_vcs.push_back(input, vc);
 	    }
 	    if(_vc_allocator) {
-	      _vc_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							      -1)));
+	      _vc_alloc_vcs.push_back(input, vc);
 	    }
-	    if(_noq) {
-	      _UpdateNOQ(input, vc, nf);
+	    if(_NOQ<P>()) {
+	      _UpdateNOQ<P>(input, vc, nf);
 	    }
 	  }
 	} else {
-	  if(_hold_switch_for_packet) {
-	    if(f->watch) {
+	  if(_HoldSwitch<P>()) {
+	    if(_Watch<P>(f)) {
 	      *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 			 << "Setting up switch hold for VC " << vc
 			 << " at input " << input
@@ -2087,16 +2192,14 @@ void IQRouter::_SWAllocUpdate( )
 	    _switch_hold_vc[expanded_input] = vc;
 	    _switch_hold_in[expanded_input] = expanded_output;
 	    _switch_hold_out[expanded_output] = expanded_input;
-	    _sw_hold_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							   -1)));
+	    _sw_hold_vcs.push_back(input, vc);
 	  } else {
-	    _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first,
-							    -1)));
+	    _sw_alloc_vcs.push_back(input, vc);
 	  }
 	}
       }
     } else {
-      if(f->watch) {
+      if(_Watch<P>(f)) {
 	*gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		   << "  No output port allocated." << endl;
       }
@@ -2121,7 +2224,7 @@ void IQRouter::_SWAllocUpdate( )
       }
 #endif
 
-      _sw_alloc_vcs.push_back(make_pair(-1, make_pair(item.second.first, -1)));
+      _sw_alloc_vcs.push_back(input, vc);
     }
     _sw_alloc_vcs.pop_front();
   }
@@ -2132,25 +2235,24 @@ void IQRouter::_SWAllocUpdate( )
 // switch traversal
 //------------------------------------------------------------------------------
 
+template<class P>
 void IQRouter::_SwitchEvaluate( )
 {
-  for(deque<pair<int, pair<Flit *, pair<int, int> > > >::iterator iter = _crossbar_flits.begin();
-      iter != _crossbar_flits.end();
-      ++iter) {
+  for(int n = 0; n < _crossbar_flits.size(); ++n) {
     
-    int const time = iter->first;
+    int const time = _crossbar_flits.time(n);
     if(time >= 0) {
       break;
     }
-    iter->first = GetSimTime() + _crossbar_delay - 1;
+    _crossbar_flits.time(n) = GetSimTime() + _crossbar_delay - 1;
 
-    Flit const * const f = iter->second.first;
+    Flit const * const f = _crossbar_flits.flit(n);
     assert(f);
 
-    int const expanded_input = iter->second.second.first;
-    int const expanded_output = iter->second.second.second;
+    int const expanded_input = _crossbar_flits.input(n);
+    int const expanded_output = _crossbar_flits.output(n);
       
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Beginning crossbar traversal for flit " << f->id
 		 << " from input " << (expanded_input / _input_speedup)
@@ -2162,29 +2264,28 @@ void IQRouter::_SwitchEvaluate( )
   }
 }
 
+template<class P>
 void IQRouter::_SwitchUpdate( )
 {
   while(!_crossbar_flits.empty()) {
 
-    pair<int, pair<Flit *, pair<int, int> > > const & item = _crossbar_flits.front();
-
-    int const time = item.first;
+    int const time = _crossbar_flits.time(0);
     if((time < 0) || (GetSimTime() < time)) {
       break;
     }
     assert(GetSimTime() == time);
 
-    Flit * const f = item.second.first;
+    Flit * const f = _crossbar_flits.flit(0);
     assert(f);
 
-    int const expanded_input = item.second.second.first;
+    int const expanded_input = _crossbar_flits.input(0);
     int const input = expanded_input / _input_speedup;
     assert((input >= 0) && (input < _inputs));
-    int const expanded_output = item.second.second.second;
+    int const expanded_output = _crossbar_flits.output(0);
     int const output = expanded_output / _output_speedup;
     assert((output >= 0) && (output < _outputs));
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Completed crossbar traversal for flit " << f->id
 		 << " from input " << input
@@ -2195,7 +2296,7 @@ void IQRouter::_SwitchUpdate( )
     }
     _switchMonitor->traversal(input, output, f) ;
 
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Buffering flit " << f->id
 		 << " at output " << output
@@ -2216,20 +2317,20 @@ void IQRouter::_SwitchUpdate( )
 
 void IQRouter::_OutputQueuing( )
 {
-  for(map<int, Credit *>::const_iterator iter = _out_queue_credits.begin();
-      iter != _out_queue_credits.end();
-      ++iter) {
+  for(int input = first_set_bit(&_out_queue_mask[0], _inputs, 0);
+      input >= 0;
+      input = first_set_bit(&_out_queue_mask[0], _inputs, 0)) {
 
-    int const input = iter->first;
     assert((input >= 0) && (input < _inputs));
+    _out_queue_mask[input / 64] &= ~(1ULL << (input % 64));
 
-    Credit * const c = iter->second;
+    Credit * const c = _out_queue_credits[input];
     assert(c);
-    assert(!c->vc.empty());
+    assert(c->HasVCs());
+    _out_queue_credits[input] = NULL;
 
     _credit_buffer[input].push(c);
   }
-  _out_queue_credits.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -2278,6 +2379,40 @@ void IQRouter::_SendCredits( )
 // misc.
 //------------------------------------------------------------------------------
 
+// the buffers, buffer states and allocators save their own state as 
+// children of the router
+void IQRouter::_Serialize( Checkpoint & cp )
+{
+  Router::_Serialize( cp );
+  cp.Check( "num_vcs", _vcs );
+  cp.Value( _active );
+  cp.Value( _in_queue_flits );
+  cp.Value( _in_queue_mask );
+  cp.Value( _proc_credits );
+  _route_vcs.Serialize( cp );
+  _vc_alloc_vcs.Serialize( cp );
+  _sw_hold_vcs.Serialize( cp );
+  _sw_alloc_vcs.Serialize( cp );
+  _crossbar_flits.Serialize( cp );
+  cp.Value( _out_queue_credits );
+  cp.Value( _out_queue_mask );
+  cp.Value( _vc_rr_offset );
+  cp.Value( _sw_rr_offset );
+  cp.Value( _output_buffer );
+  cp.Value( _credit_buffer );
+  cp.Value( _switch_hold_in );
+  cp.Value( _switch_hold_out );
+  cp.Value( _switch_hold_vc );
+  cp.Value( _noq_next_output_port );
+  cp.Value( _noq_next_vc_start );
+  cp.Value( _noq_next_vc_end );
+#ifdef TRACK_FLOWS
+  cp.Value( _outstanding_classes );
+#endif
+  _bufferMonitor->Serialize( cp );
+  _switchMonitor->Serialize( cp );
+}
+
 void IQRouter::Display( ostream & os ) const
 {
   for ( int input = 0; input < _inputs; ++input ) {
@@ -2345,12 +2480,13 @@ vector<int> IQRouter::MaxCredits() const
   return result;
 }
 
+template<class P>
 void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
-  assert(!_routing_delay);
+  assert(_Lookahead<P>());
   assert(f);
   assert(f->vc == vc);
   assert(f->head);
-  set<OutputSet::sSetElement> sl = f->la_route_set.GetSet();
+  OutputSet::ElementList const & sl = f->cold().la_route_set.GetSet();
   assert(sl.size() == 1);
   int out_port = sl.begin()->output_port;
   const FlitChannel * channel = _output_channels[out_port];
@@ -2359,9 +2495,9 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     int in_channel = channel->GetSinkPort();
     OutputSet nos;
     _rf(router, f, in_channel, &nos, false);
-    sl = nos.GetSet();
-    assert(sl.size() == 1);
-    OutputSet::sSetElement const & se = *sl.begin();
+    OutputSet::ElementList const & nsl = nos.GetSet();
+    assert(nsl.size() == 1);
+    OutputSet::sSetElement const & se = *nsl.begin();
     int next_output_port = se.output_port;
     assert(next_output_port >= 0);
     assert(_noq_next_output_port[input][vc] < 0);
@@ -2376,10 +2512,64 @@ void IQRouter::_UpdateNOQ(int input, int vc, Flit const * f) {
     assert(_noq_next_vc_end[input][vc] < 0);
     _noq_next_vc_end[input][vc] = next_vc_end;
     assert(next_vc_start <= next_vc_end);
-    if(f->watch) {
+    if(_Watch<P>(f)) {
       *gWatchOut << GetSimTime() << " | " << FullName() << " | "
 		 << "Computing lookahead routing information for flit " << f->id
 		 << " (NOQ)." << endl;
     }
   }
 }
+
+
+//------------------------------------------------------------------------------
+// specialized variants
+//------------------------------------------------------------------------------
+
+template<class P>
+class IQRouterVariant : public IQRouter {
+
+  virtual void _InternalStep( )
+  {
+    _Step<P>( );
+  }
+
+public:
+
+  IQRouterVariant( Configuration const & config,
+		   Module *parent, string const & name, int id,
+		   int inputs, int outputs )
+    : IQRouter( config, parent, name, id, inputs, outputs )
+  {
+  }
+
+};
+
+IQRouter * IQRouter::New( Configuration const & config,
+			  Module *parent, string const & name, int id,
+			  int inputs, int outputs )
+{
+  bool const speculative = (config.GetInt("speculative") > 0);
+  bool const lookahead = !config.GetInt("routing_delay");
+  bool const hold_switch = (config.GetInt("hold_switch_for_packet") > 0);
+  bool const noq = (config.GetInt("noq") > 0);
+  bool const vc_busy_when_full = (config.GetInt("vc_busy_when_full") > 0);
+  
+  // the variants below cover the common combinations of features; anything
+  // else, and any run that watches flits, uses the generic router
+  if(!gWatchOut && !hold_switch && !noq && !vc_busy_when_full) {
+    if(speculative) {
+      if(lookahead) {
+	return new IQRouterVariant<IQRouterPolicy<true, true, false, false, false> >(config, parent, name, id, inputs, outputs);
+      } else {
+	return new IQRouterVariant<IQRouterPolicy<true, false, false, false, false> >(config, parent, name, id, inputs, outputs);
+      }
+    } else {
+      if(lookahead) {
+	return new IQRouterVariant<IQRouterPolicy<false, true, false, false, false> >(config, parent, name, id, inputs, outputs);
+      } else {
+	return new IQRouterVariant<IQRouterPolicy<false, false, false, false, false> >(config, parent, name, id, inputs, outputs);
+      }
+    }
+  }
+  return new IQRouter(config, parent, name, id, inputs, outputs);
+}
@@ -33,6 +33,7 @@
 #include <queue>
 #include <set>
 #include <map>
+#include <cassert>
 
 #include "router.hpp"
 #include "routefunc.hpp"
@@ -48,6 +49,30 @@ class Allocator;
 class SwitchMonitor;
 class BufferMonitor;
 
+// Router features that can be fixed at compile time. The generic policy 
+// reads them from the configuration at run time; the specialized policies 
+// fix them, so that the code for disabled features, as well as all flit 
+// watch logging, is compiled out.
+struct IQRouterGenericPolicy {
+  static const bool generic = true;
+  static const bool speculative = false;
+  static const bool lookahead = false;
+  static const bool hold_switch = false;
+  static const bool noq = false;
+  static const bool vc_busy_when_full = false;
+};
+
+template<bool Speculative, bool Lookahead, bool HoldSwitch, bool NOQ, 
+	 bool VCBusyWhenFull>
+struct IQRouterPolicy {
+  static const bool generic = false;
+  static const bool speculative = Speculative;
+  static const bool lookahead = Lookahead;
+  static const bool hold_switch = HoldSwitch;
+  static const bool noq = NOQ;
+  static const bool vc_busy_when_full = VCBusyWhenFull;
+};
+
 class IQRouter : public Router {
 
   int _vcs;
@@ -67,18 +92,70 @@ class IQRouter : public Router {
   int _vc_alloc_delay;
   int _sw_alloc_delay;
   
-  map<int, Flit *> _in_queue_flits;
+  // A FIFO of entries waiting in a pipeline stage, stored as parallel 
+  // arrays in a ring buffer. Each entry records the cycle at which the 
+  // stage completes (-1 until it has been evaluated), the input and VC it
+  // belongs to (or, for the crossbar, the flit and its expanded input), and
+  // the stage's result (output or stall reason). The ring only grows if 
+  // more entries are pending than were provisioned for at construction.
+  class StageQueue {
+    int _mask;
+    int _head;
+    int _size;
+    vector<int> _time;
+    vector<int> _input;
+    vector<int> _vc;
+    vector<int> _output;
+    vector<Flit *> _flit;
+    void _Grow( );
+  public:
+    StageQueue( ) : _mask(-1), _head(0), _size(0) {}
+    void Reserve( int entries );
+    inline bool empty( ) const { return !_size; }
+    inline int size( ) const { return _size; }
+    inline void push_back( int input, int vc, int output = -1, 
+			   Flit * f = NULL ) {
+      if(_size > _mask) {
+	_Grow( );
+      }
+      int const i = (_head + _size) & _mask;
+      _time[i] = -1;
+      _input[i] = input;
+      _vc[i] = vc;
+      _output[i] = output;
+      _flit[i] = f;
+      ++_size;
+    }
+    inline void pop_front( ) {
+      assert(_size > 0);
+      _head = (_head + 1) & _mask;
+      --_size;
+    }
+    // accessors for the n-th entry from the front
+    inline int & time( int n ) { return _time[(_head + n) & _mask]; }
+    inline int input( int n ) const { return _input[(_head + n) & _mask]; }
+    inline int vc( int n ) const { return _vc[(_head + n) & _mask]; }
+    inline int & output( int n ) { return _output[(_head + n) & _mask]; }
+    inline Flit * flit( int n ) const { return _flit[(_head + n) & _mask]; }
+    void Serialize( Checkpoint & cp );
+  };
+
+  // flits received this cycle and credits to be sent, indexed by port; the
+  // bitmaps mark the ports that have an entry
+  vector<Flit *> _in_queue_flits;
+  vector<unsigned long long> _in_queue_mask;
 
   deque<pair<int, pair<Credit *, int> > > _proc_credits;
 
-  deque<pair<int, pair<int, int> > > _route_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _vc_alloc_vcs;  
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_hold_vcs;
-  deque<pair<int, pair<pair<int, int>, int> > > _sw_alloc_vcs;
+  StageQueue _route_vcs;
+  StageQueue _vc_alloc_vcs;  
+  StageQueue _sw_hold_vcs;
+  StageQueue _sw_alloc_vcs;
 
-  deque<pair<int, pair<Flit *, pair<int, int> > > > _crossbar_flits;
+  StageQueue _crossbar_flits;
 
-  map<int, Credit *> _out_queue_credits;
+  vector<Credit *> _out_queue_credits;
+  vector<unsigned long long> _out_queue_mask;
 
   vector<Buffer *> _buf;
   vector<BufferState *> _next_buf;
@@ -116,28 +193,37 @@ class IQRouter : public Router {
 
   virtual void _InternalStep( );
 
-  bool _SWAllocAddReq(int input, int vc, int output);
+  virtual void _Serialize( Checkpoint & cp );
+
+  template<class P> bool _Speculative( ) const;
+  template<class P> bool _Lookahead( ) const;
+  template<class P> bool _HoldSwitch( ) const;
+  template<class P> bool _NOQ( ) const;
+  template<class P> bool _VCBusyWhenFull( ) const;
+  template<class P> bool _Watch( Flit const * f ) const;
 
-  void _InputQueuing( );
+  template<class P> bool _SWAllocAddReq(int input, int vc, int output);
 
-  void _RouteEvaluate( );
-  void _VCAllocEvaluate( );
-  void _SWHoldEvaluate( );
-  void _SWAllocEvaluate( );
-  void _SwitchEvaluate( );
+  template<class P> void _InputQueuing( );
 
-  void _RouteUpdate( );
-  void _VCAllocUpdate( );
-  void _SWHoldUpdate( );
-  void _SWAllocUpdate( );
-  void _SwitchUpdate( );
+  template<class P> void _RouteEvaluate( );
+  template<class P> void _VCAllocEvaluate( );
+  template<class P> void _SWHoldEvaluate( );
+  template<class P> void _SWAllocEvaluate( );
+  template<class P> void _SwitchEvaluate( );
+
+  template<class P> void _RouteUpdate( );
+  template<class P> void _VCAllocUpdate( );
+  template<class P> void _SWHoldUpdate( );
+  template<class P> void _SWAllocUpdate( );
+  template<class P> void _SwitchUpdate( );
 
   void _OutputQueuing( );
 
   void _SendFlits( );
   void _SendCredits( );
   
-  void _UpdateNOQ(int input, int vc, Flit const * f);
+  template<class P> void _UpdateNOQ(int input, int vc, Flit const * f);
 
   // ----------------------------------------
   //
@@ -148,8 +234,19 @@ class IQRouter : public Router {
   SwitchMonitor * _switchMonitor ;
   BufferMonitor * _bufferMonitor ;
   
+protected:
+
+  // one internal router cycle, with the features fixed by the policy P
+  template<class P> void _Step( );
+
 public:
 
+  // Creates an input-queued router, specialized for the configured 
+  // features if they match one of the precompiled variants
+  static IQRouter * New( Configuration const & config,
+			 Module *parent, string const & name, int id,
+			 int inputs, int outputs );
+
   IQRouter( Configuration const & config,
 	    Module *parent, string const & name, int id,
 	    int inputs, int outputs );
@@ -160,6 +257,8 @@ public:
 
   virtual void ReadInputs( );
   virtual void WriteOutputs( );
+
+  virtual bool Idle( ) const;
   
   void Display( ostream & os = cout ) const;
 
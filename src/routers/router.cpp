@@ -42,6 +42,7 @@
 #include <iostream>
 #include <cassert>
 #include "router.hpp"
+#include "checkpoint.hpp"
 
 //////////////////Sub router types//////////////////////
 #include "iq_router.hpp"
@@ -92,6 +93,7 @@ void Router::AddInputChannel( FlitChannel *channel, CreditChannel *backchannel )
   _input_channels.push_back( channel );
   _input_credits.push_back( backchannel );
   channel->SetSink( this, _input_channels.size() - 1 ) ;
+  channel->SetReceiver( this );
 }
 
 void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel )
@@ -100,6 +102,7 @@ void Router::AddOutputChannel( FlitChannel *channel, CreditChannel *backchannel
   _output_credits.push_back( backchannel );
   _channel_faults.push_back( false );
   channel->SetSource( this, _output_channels.size() - 1 ) ;
+  backchannel->SetReceiver( this );
 }
 
 void Router::Evaluate( )
@@ -111,6 +114,27 @@ void Router::Evaluate( )
   }
 }
 
+void Router::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "router inputs", _inputs );
+  cp.Check( "router outputs", _outputs );
+  cp.Value( _partial_internal_cycles );
+#ifdef TRACK_FLOWS
+  cp.Value( _received_flits );
+  cp.Value( _stored_flits );
+  cp.Value( _sent_flits );
+  cp.Value( _outstanding_credits );
+  cp.Value( _active_packets );
+#endif
+#ifdef TRACK_STALLS
+  cp.Value( _buffer_busy_stalls );
+  cp.Value( _buffer_conflict_stalls );
+  cp.Value( _buffer_full_stalls );
+  cp.Value( _buffer_reserved_stalls );
+  cp.Value( _crossbar_conflict_stalls );
+#endif
+}
+
 void Router::OutChannelFault( int c, bool fault )
 {
   assert( ( c >= 0 ) && ( (size_t)c < _channel_faults.size( ) ) );
@@ -133,7 +157,7 @@ Router *Router::NewRouter( const Configuration& config,
   const string type = config.GetStr( "router" );
   Router *r = NULL;
   if ( type == "iq" ) {
-    r = new IQRouter( config, parent, name, id, inputs, outputs );
+    r = IQRouter::New( config, parent, name, id, inputs, outputs );
   } else if ( type == "event" ) {
     r = new EventRouter( config, parent, name, id, inputs, outputs );
   } else if ( type == "chaos" ) {
@@ -90,6 +90,8 @@ protected:
 
   virtual void _InternalStep() = 0;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   Router( const Configuration& config,
 	  Module *parent, const string & name, int id,
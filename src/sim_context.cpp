@@ -0,0 +1,146 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*sim_context.cpp
+ *
+ *Only the state that is read while network modules are evaluated is 
+ *captured; the routing function maps and the source queues are used by 
+ *the thread running the simulation only, and network modules draw random
+ *numbers from generators of their own (see timed_module.hpp). The flit 
+ *and credit pools are shared by pointer, so that flits and credits can 
+ *move freely between a simulation's threads.
+ *
+ */
+
+#include "booksim.hpp"
+#include "sim_context.hpp"
+#include "globals.hpp"
+#include "routefunc.hpp"
+#include "cmesh.hpp"
+
+// defined in main.cpp, dragonfly.cpp, flatfly_onchip.cpp and anynet.cpp
+extern thread_local TrafficManager * trafficManager;
+extern thread_local int gP, gA, gG;
+extern thread_local int _xcount, _ycount, _xrouter, _yrouter;
+extern thread_local map<int, int> * global_routing_table;
+
+SimContext::SimContext()
+  : _print_activity(false), _k(0), _n(0), _c(0), _nodes(0), _trace(false),
+    _watch_out(NULL), _traffic_manager(NULL), _num_vcs(0),
+    _read_req_begin_vc(0), _read_req_end_vc(0),
+    _write_req_begin_vc(0), _write_req_end_vc(0),
+    _read_reply_begin_vc(0), _read_reply_end_vc(0),
+    _write_reply_begin_vc(0), _write_reply_end_vc(0),
+    _dragonfly_p(0), _dragonfly_a(0), _dragonfly_g(0),
+    _flatfly_xcount(0), _flatfly_ycount(0), _flatfly_xrouter(0),
+    _flatfly_yrouter(0),
+    _anynet_routing_table(NULL), _cmesh_cx(0), _cmesh_cy(0),
+    _cmesh_node_shift_x(0), _cmesh_node_shift_y(0), _cmesh_port_shift_y(0),
+    _flits(NULL), _credits(NULL)
+{
+}
+
+void SimContext::Capture()
+{
+  _print_activity = gPrintActivity;
+  _k = gK;
+  _n = gN;
+  _c = gC;
+  _nodes = gNodes;
+  _trace = gTrace;
+  _watch_out = gWatchOut;
+  _traffic_manager = trafficManager;
+
+  _num_vcs = gNumVCs;
+  _read_req_begin_vc = gReadReqBeginVC;
+  _read_req_end_vc = gReadReqEndVC;
+  _write_req_begin_vc = gWriteReqBeginVC;
+  _write_req_end_vc = gWriteReqEndVC;
+  _read_reply_begin_vc = gReadReplyBeginVC;
+  _read_reply_end_vc = gReadReplyEndVC;
+  _write_reply_begin_vc = gWriteReplyBeginVC;
+  _write_reply_end_vc = gWriteReplyEndVC;
+
+  _dragonfly_p = gP;
+  _dragonfly_a = gA;
+  _dragonfly_g = gG;
+  _flatfly_xcount = _xcount;
+  _flatfly_ycount = _ycount;
+  _flatfly_xrouter = _xrouter;
+  _flatfly_yrouter = _yrouter;
+  _anynet_routing_table = global_routing_table;
+  _cmesh_cx = CMesh::_cX;
+  _cmesh_cy = CMesh::_cY;
+  _cmesh_node_shift_x = CMesh::_memo_NodeShiftX;
+  _cmesh_node_shift_y = CMesh::_memo_NodeShiftY;
+  _cmesh_port_shift_y = CMesh::_memo_PortShiftY;
+
+  // create the pools if necessary, so that the simulation's threads do not
+  // end up with pools of their own
+  _flits = Flit::_Pool();
+  _credits = Credit::_Pool();
+  _credits->shared = true;
+}
+
+void SimContext::Install() const
+{
+  gPrintActivity = _print_activity;
+  gK = _k;
+  gN = _n;
+  gC = _c;
+  gNodes = _nodes;
+  gTrace = _trace;
+  gWatchOut = _watch_out;
+  trafficManager = _traffic_manager;
+
+  gNumVCs = _num_vcs;
+  gReadReqBeginVC = _read_req_begin_vc;
+  gReadReqEndVC = _read_req_end_vc;
+  gWriteReqBeginVC = _write_req_begin_vc;
+  gWriteReqEndVC = _write_req_end_vc;
+  gReadReplyBeginVC = _read_reply_begin_vc;
+  gReadReplyEndVC = _read_reply_end_vc;
+  gWriteReplyBeginVC = _write_reply_begin_vc;
+  gWriteReplyEndVC = _write_reply_end_vc;
+
+  gP = _dragonfly_p;
+  gA = _dragonfly_a;
+  gG = _dragonfly_g;
+  _xcount = _flatfly_xcount;
+  _ycount = _flatfly_ycount;
+  _xrouter = _flatfly_xrouter;
+  _yrouter = _flatfly_yrouter;
+  global_routing_table = _anynet_routing_table;
+  CMesh::_cX = _cmesh_cx;
+  CMesh::_cY = _cmesh_cy;
+  CMesh::_memo_NodeShiftX = _cmesh_node_shift_x;
+  CMesh::_memo_NodeShiftY = _cmesh_node_shift_y;
+  CMesh::_memo_PortShiftY = _cmesh_port_shift_y;
+
+  Flit::_pool = _flits;
+  Credit::_pool = _credits;
+}
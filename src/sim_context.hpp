@@ -0,0 +1,90 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _SIM_CONTEXT_HPP_
+#define _SIM_CONTEXT_HPP_
+
+#include <map>
+#include <iostream>
+
+#include "flit.hpp"
+#include "credit.hpp"
+
+using namespace std;
+
+class TrafficManager;
+
+// The simulator keeps its process-wide state (the globals in globals.hpp
+// and routefunc.hpp, topology parameters used by the routing functions, 
+// the flit and credit pools and the random number generator) in 
+// thread-local variables, so that independent simulations can run side by
+// side on different threads of one process.
+//
+// Threads that evaluate network modules on behalf of a simulation, such as
+// the workers of a ThreadPool, need to see that simulation's state. A
+// SimContext captures the part of the state that routers, channels and 
+// routing functions use from the thread running the simulation and 
+// installs it on another thread.
+class SimContext {
+
+  bool _print_activity;
+  int _k;
+  int _n;
+  int _c;
+  int _nodes;
+  bool _trace;
+  ostream * _watch_out;
+  TrafficManager * _traffic_manager;
+
+  int _num_vcs;
+  int _read_req_begin_vc, _read_req_end_vc;
+  int _write_req_begin_vc, _write_req_end_vc;
+  int _read_reply_begin_vc, _read_reply_end_vc;
+  int _write_reply_begin_vc, _write_reply_end_vc;
+
+  int _dragonfly_p, _dragonfly_a, _dragonfly_g;
+  int _flatfly_xcount, _flatfly_ycount, _flatfly_xrouter, _flatfly_yrouter;
+  map<int, int> * _anynet_routing_table;
+  int _cmesh_cx, _cmesh_cy;
+  int _cmesh_node_shift_x, _cmesh_node_shift_y, _cmesh_port_shift_y;
+
+  Flit::sPool * _flits;
+  Credit::sPool * _credits;
+
+public:
+
+  SimContext();
+
+  // Copies the calling thread's state into the context
+  void Capture();
+
+  // Makes the captured state the calling thread's state
+  void Install() const;
+
+};
+
+#endif
@@ -39,8 +39,10 @@
 #include <limits>
 #include <cmath>
 #include <cstdio>
+#include <cassert>
 
 #include "stats.hpp"
+#include "checkpoint.hpp"
 
 Stats::Stats( Module *parent, const string &name,
 	      double bin_size, int num_bins ) :
@@ -114,6 +116,36 @@ void Stats::AddSample( double val )
   _hist[b]++;
 }
 
+void Stats::Add( const Stats & s )
+{
+  assert( ( s._num_bins == _num_bins ) && ( s._bin_size == _bin_size ) );
+
+  if ( s._num_samples == 0 ) {
+    return;
+  }
+  _num_samples += s._num_samples;
+  _sample_sum += s._sample_sum;
+  _sample_squared_sum += s._sample_squared_sum;
+
+  _max = !(s._max <= _max) ? s._max : _max;
+  _min = !(s._min >= _min) ? s._min : _min;
+
+  for ( int b = 0; b < _num_bins; ++b ) {
+    _hist[b] += s._hist[b];
+  }
+}
+
+void Stats::_Serialize( Checkpoint & cp )
+{
+  cp.Check( "number of bins", _num_bins );
+  cp.Value( _num_samples );
+  cp.Value( _sample_sum );
+  cp.Value( _sample_squared_sum );
+  cp.Value( _min );
+  cp.Value( _max );
+  cp.Value( _hist );
+}
+
 void Stats::Display( ostream & os ) const
 {
   os << *this << endl;
@@ -44,6 +44,8 @@ class Stats : public Module {
 
   vector<int> _hist;
 
+  virtual void _Serialize( Checkpoint & cp );
+
 public:
   Stats( Module *parent, const string &name,
 	 double bin_size = 1.0, int num_bins = 10 );
@@ -57,12 +59,17 @@ public:
   double Sum( ) const;
   double SquaredSum( ) const;
   int    NumSamples( ) const;
+  int    NumBins( ) const { return _num_bins; }
+  double BinSize( ) const { return _bin_size; }
 
   void AddSample( double val );
   inline void AddSample( int val ) {
     AddSample( (double)val );
   }
 
+  // adds the samples of another set of statistics with the same bins
+  void Add( const Stats & s );
+
   int GetBin(int b){ return _hist[b];}
 
   void Display( ostream & os = cout ) const;
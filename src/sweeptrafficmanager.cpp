@@ -0,0 +1,422 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include <limits>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+
+#include "random_utils.hpp"
+#include "sweeptrafficmanager.hpp"
+#include "network.hpp"
+#include "checkpoint.hpp"
+
+// columns written for each point and traffic class
+static char const * const _stat_names[] = {
+  "min_plat", "avg_plat", "max_plat",
+  "min_nlat", "avg_nlat", "max_nlat",
+  "min_flat", "avg_flat", "max_flat",
+  "avg_frag",
+  "sent_packets", "accepted_packets",
+  "sent_flits", "accepted_flits",
+  "hops"
+};
+static int const _num_stats = sizeof(_stat_names) / sizeof(_stat_names[0]);
+
+// like the awk arithmetic in sweep.sh, keep the rates from accumulating
+// rounding errors as steps are added up
+static double _RoundRate( double rate )
+{
+  return floor( rate * 1e9 + 0.5 ) / 1e9;
+}
+
+SweepTrafficManager::SweepTrafficManager( const Configuration &config, 
+					  const vector<Network *> & net )
+  : TrafficManager(config, net), _config(config), _net_state(net_empty),
+    _zero_load_latency(0.0), _saturation_rate(0.0)
+{
+  _measure_latency = true;
+
+  if(!_checkpoint_out.empty() || !_checkpoint_in.empty()) {
+    Error("Checkpoints are not supported for sweeps.");
+  }
+
+  _injection_process_type = config.GetStrArray("injection_process");
+  _injection_process_type.resize(_classes, _injection_process_type.back());
+  _injection_rate_uses_flits = (config.GetInt("injection_rate_uses_flits") > 0);
+
+  // each point starts from the same random state unless the seed was
+  // taken from the clock
+  _reseed = (config.GetStr("seed") != "time");
+
+  _initial_step = config.GetFloat("sweep_initial_step");
+  _minimum_step = config.GetFloat("sweep_minimum_step");
+  _zero_load_rate = config.GetFloat("sweep_zero_load_rate");
+  if((_initial_step <= 0.0) || (_minimum_step <= 0.0)) {
+    Error("Sweep step sizes must be positive.");
+  }
+  _backtrack = (config.GetInt("sweep_backtrack") > 0);
+  _refine = (config.GetInt("sweep_refine") > 0);
+  _warm_start = (config.GetInt("sweep_warm_start") > 0);
+
+  _sweep_format = config.GetStr("sweep_format");
+  if((_sweep_format != "csv") && (_sweep_format != "json")) {
+    Error("Unknown sweep output format: " + _sweep_format);
+  }
+  string const sweep_out = config.GetStr("sweep_out");
+  if((sweep_out != "") && (sweep_out != "-")) {
+    _sweep_file.open(sweep_out.c_str());
+    if(!_sweep_file) {
+      Error("Unable to open sweep output file: " + sweep_out);
+    }
+  }
+
+  // only the input-queued router can be saved
+  _restore = (config.GetStr("router") == "iq");
+  if(_restore) {
+    Checkpoint cp(_fresh_state, false);
+    Serialize(cp);
+    for(int i = 0; i < _subnets; ++i) {
+      _net[i]->Serialize(cp);
+    }
+    cp.Section("end");
+  } else {
+    cout << "WARNING: " << config.GetStr("router") << " routers cannot be saved;"
+	 << " each sweep point starts from the router state left by the previous one." << endl;
+  }
+}
+
+void SweepTrafficManager::_SetRate( double rate )
+{
+  for(int c = 0; c < _classes; ++c) {
+    _load[c] = rate;
+    if(_injection_rate_uses_flits) {
+      _load[c] /= _GetAveragePacketSize(c);
+    }
+    delete _injection_process[c];
+    _injection_process[c] = InjectionProcess::New(_injection_process_type[c], 
+						  _nodes, _load[c], &_config);
+  }
+}
+
+// drops the packets that are still waiting in the source queues, except
+// for those that have already started injecting
+void SweepTrafficManager::_DiscardQueuedPackets( )
+{
+  for(int s = 0; s < _nodes; ++s) {
+    for(int c = 0; c < _classes; ++c) {
+      list<sQueuedPacket> & pp = _partial_packets[s][c];
+      list<sQueuedPacket>::iterator iter = pp.begin();
+      if((iter != pp.end()) && !iter->flit->head) {
+	++iter;
+      }
+      while(iter != pp.end()) {
+	sQueuedPacket const & p = *iter;
+	// only the packet at the head of the queue has a flit allocated
+	if(p.flit) {
+	  p.flit->Free();
+	}
+	_total_in_flight_flits[c] -= p.size;
+	_total_in_flight_ctime[c] -= (long long)p.size * p.ctime;
+	if(p.record) {
+	  _measured_in_flight_flits[c] -= p.size;
+	}
+#ifdef TRACK_FLIT_IDS
+	for(int i = 0; i < p.size; ++i) {
+	  _total_in_flight_ids[c].Erase(p.id + i);
+	  if(p.record) {
+	    _measured_in_flight_ids[c].Erase(p.id + i);
+	  }
+	}
+#endif
+	iter = pp.erase(iter);
+      }
+    }
+  }
+}
+
+// starts a new simulation on top of the traffic left over from the
+// previous one, which ended with its measured packets drained
+void SweepTrafficManager::_ResumeSim( )
+{
+  for(int s = 0; s < _nodes; ++s) {
+    _qdrained[s].assign(_classes, false);
+  }
+  _sim_state = warming_up;
+  _ClearStats( );
+  _ScheduleInjections( );
+}
+
+// returns the drained simulation to the state it was built in, so that
+// arbiter pointers, injection VCs and the like do not carry over from the
+// previous point and each point gives the same results as a separate run
+void SweepTrafficManager::_RestoreFreshState( )
+{
+  if(!_restore) {
+    return;
+  }
+  {
+    Checkpoint cp(_fresh_state, true);
+    Serialize(cp);
+    for(int i = 0; i < _subnets; ++i) {
+      _net[i]->Serialize(cp);
+    }
+    cp.Section("end");
+  }
+  // the routers' random streams were saved as well
+  if(!_reseed) {
+    for(int i = 0; i < _subnets; ++i) {
+      _net[i]->SeedRandom(RandomStreamSeed(i));
+    }
+  }
+}
+
+bool SweepTrafficManager::_RunPoint( double rate, double * latency )
+{
+  cout << "SWEEP: Simulating for injection rate " << rate << "..." << endl;
+
+  _SetRate( rate );
+  _ClearOverallStats( );
+
+  for(int sim = 0; sim < _total_sims; ++sim) {
+
+    if(_warm_start && (_net_state == net_stable)) {
+      _ResumeSim( );
+    } else {
+      if(_net_state != net_empty) {
+	cout << "Discarding queued packets ..." << endl;
+	_DiscardQueuedPackets( );
+	_DrainNetwork( );
+      }
+      if(_reseed) {
+	RandomSeed(_seed);
+      }
+      _RestoreFreshState( );
+      _ResetSim( );
+    }
+
+    if(!_SingleSim( )) {
+      cout << "Simulation unstable, ending ..." << endl;
+      _net_state = net_unstable;
+      _RecordPoint( rate, false );
+      return false;
+    }
+
+    if(_warm_start) {
+      _net_state = net_stable;
+    } else {
+      _DrainNetwork( );
+      _net_state = net_empty;
+    }
+
+    cout << "Time taken is " << _time << " cycles" <<endl; 
+
+    if(_stats_out) {
+      WriteStats(*_stats_out);
+    }
+    _UpdateOverallStats();
+  }
+
+  DisplayOverallStats();
+  if(_print_csv_results) {
+    DisplayOverallStatsCSV();
+  }
+
+  _RecordPoint( rate, true );
+
+  *latency = 0.0;
+  for(int c = 0; c < _classes; ++c) {
+    if(_measure_stats[c]) {
+      *latency = max(*latency, _overall_avg_plat[c] / (double)_total_sims);
+    }
+  }
+  return true;
+}
+
+void SweepTrafficManager::_RecordPoint( double rate, bool stable )
+{
+  double const n = (double)_total_sims;
+  for(int c = 0; c < _classes; ++c) {
+    if(_measure_stats[c] == 0) {
+      continue;
+    }
+    sPoint p;
+    p.rate = rate;
+    p.cl = c;
+    p.stable = stable;
+    if(stable) {
+      double const stats[] = {
+	_overall_min_plat[c] / n, _overall_avg_plat[c] / n, _overall_max_plat[c] / n,
+	_overall_min_nlat[c] / n, _overall_avg_nlat[c] / n, _overall_max_nlat[c] / n,
+	_overall_min_flat[c] / n, _overall_avg_flat[c] / n, _overall_max_flat[c] / n,
+	_overall_avg_frag[c] / n,
+	_overall_avg_sent_packets[c] / n, _overall_avg_accepted_packets[c] / n,
+	_overall_avg_sent[c] / n, _overall_avg_accepted[c] / n,
+	_overall_hop_stats[c] / n
+      };
+      p.stats.assign(stats, stats + _num_stats);
+    }
+    _points.push_back(p);
+  }
+}
+
+void SweepTrafficManager::_WriteCSV( ostream & os ) const
+{
+  os << "injection_rate,class,traffic,stable";
+  for(int i = 0; i < _num_stats; ++i) {
+    os << ',' << _stat_names[i];
+  }
+  os << endl;
+  for(size_t i = 0; i < _points.size(); ++i) {
+    sPoint const & p = _points[i];
+    os << p.rate << ',' << p.cl << ",\"" << _traffic[p.cl] << "\"," << p.stable;
+    for(int s = 0; s < _num_stats; ++s) {
+      os << ',';
+      if(p.stable) {
+	os << p.stats[s];
+      }
+    }
+    os << endl;
+  }
+}
+
+void SweepTrafficManager::_WriteJSON( ostream & os ) const
+{
+  os << "{" << endl
+     << "  \"zero_load_latency\": " << _zero_load_latency << "," << endl
+     << "  \"saturation_rate\": " << _saturation_rate << "," << endl
+     << "  \"points\": [" << endl;
+  for(size_t i = 0; i < _points.size(); ++i) {
+    sPoint const & p = _points[i];
+    os << "    { \"injection_rate\": " << p.rate
+       << ", \"class\": " << p.cl
+       << ", \"traffic\": \"" << _traffic[p.cl] << "\""
+       << ", \"stable\": " << (p.stable ? "true" : "false");
+    if(p.stable) {
+      for(int s = 0; s < _num_stats; ++s) {
+	os << ", \"" << _stat_names[s] << "\": ";
+	// JSON has no representation for NaN or infinity
+	if(isfinite(p.stats[s])) {
+	  os << p.stats[s];
+	} else {
+	  os << "null";
+	}
+      }
+    }
+    os << " }" << ((i + 1 < _points.size()) ? "," : "") << endl;
+  }
+  os << "  ]" << endl
+     << "}" << endl;
+}
+
+bool SweepTrafficManager::Run( )
+{
+  double lat;
+
+  cout << "SWEEP: Determining zero-load latency..." << endl;
+  if(!_RunPoint(_zero_load_rate, &_zero_load_latency)) {
+    cout << "SWEEP: Simulation run failed." << endl
+	 << "SWEEP: Aborting." << endl;
+    return false;
+  }
+  cout << "SWEEP: Zero-load latency is " << _zero_load_latency << "." << endl;
+
+  double step = _initial_step;
+  double old_rate = 0.0;
+  double rate = _RoundRate(step);
+  double last_fail = 1.0 + _minimum_step;
+
+  cout << "SWEEP: Sweeping with initial step size " << step << endl;
+
+  while(true) {
+    bool success;
+    if(rate >= last_fail) {
+      cout << "SWEEP: Already failed for injection rate " << rate << " before." << endl;
+      success = false;
+    } else {
+      success = _RunPoint(rate, &lat);
+    }
+    if(!success) {
+      cout << "SWEEP: Simulation run failed." << endl;
+      if(!_backtrack) {
+	break;
+      }
+      step /= 2.0;
+      if(step < _minimum_step) {
+	cout << "SWEEP: Step size too small." << endl;
+	break;
+      }
+      last_fail = rate;
+      cout << "SWEEP: New step size is " << step << "." << endl;
+      rate = _RoundRate(old_rate + step);
+      continue;
+    }
+    cout << "SWEEP: Latency is " << lat << "." << endl;
+    if(_refine) {
+      // add intermediate points where latency has grown quickly
+      int const ref_steps = (int)(lat / _zero_load_latency);
+      if(ref_steps > 1) {
+	double const ref_step = step / (double)ref_steps;
+	if(ref_step >= _minimum_step) {
+	  cout << "SWEEP: Adding " << ref_steps - 1 << " intermediate step(s)..." << endl;
+	  for(int i = 1; i < ref_steps; ++i) {
+	    double const ref_rate = _RoundRate(old_rate + i * ref_step);
+	    if(!_RunPoint(ref_rate, &lat)) {
+	      cout << "SWEEP: Simulation failed unexpectedly." << endl;
+	    }
+	  }
+	} else {
+	  cout << "SWEEP: Interval too small to refine." << endl;
+	}
+      }
+    }
+    old_rate = rate;
+    rate = _RoundRate(rate + step);
+  }
+  _saturation_rate = old_rate;
+
+  cout << "SWEEP: Parameter sweep complete." << endl
+       << "SWEEP: Zero-load latency: " << _zero_load_latency << endl
+       << "SWEEP: Saturation throughput: " << _saturation_rate << endl;
+
+  stable_sort(_points.begin(), _points.end());
+
+  ostream & os = _sweep_file.is_open() ? _sweep_file : cout;
+  if(_sweep_format == "json") {
+    _WriteJSON(os);
+  } else {
+    _WriteCSV(os);
+  }
+  os.flush();
+  if(!os) {
+    Error("Unable to write sweep output.");
+  }
+
+  return true;
+}
@@ -0,0 +1,105 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#ifndef _SWEEPTRAFFICMANAGER_HPP_
+#define _SWEEPTRAFFICMANAGER_HPP_
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+
+#include "config_utils.hpp"
+#include "trafficmanager.hpp"
+
+// Latency-throughput sweep: runs a latency simulation for a series of
+// injection rates on the same network, searching for the saturation rate
+// the same way utils/sweep.sh does, and writes all points into one table.
+class SweepTrafficManager : public TrafficManager {
+
+protected:
+
+  // kept to rebuild the injection processes for each rate
+  Configuration _config;
+  vector<string> _injection_process_type;
+  bool _injection_rate_uses_flits;
+
+  bool _reseed;
+
+  double _initial_step;
+  double _minimum_step;
+  double _zero_load_rate;
+  bool _backtrack;
+  bool _refine;
+  bool _warm_start;
+
+  string _sweep_format;
+  // opened up front, so that a bad path is reported before the sweep runs
+  ofstream _sweep_file;
+
+  // what the previous simulation left in the network
+  enum eNetState { net_empty, net_stable, net_unstable };
+  eNetState _net_state;
+
+  // the simulation as built, restored before each point that does not 
+  // continue from the previous one
+  bool _restore;
+  stringstream _fresh_state;
+
+  struct sPoint {
+    double rate;
+    int cl;
+    bool stable;
+    vector<double> stats;
+    bool operator<( sPoint const & p ) const {
+      return ( rate < p.rate ) || ( ( rate == p.rate ) && ( cl < p.cl ) );
+    }
+  };
+  vector<sPoint> _points;
+
+  double _zero_load_latency;
+  double _saturation_rate;
+
+  void _SetRate( double rate );
+  void _DiscardQueuedPackets( );
+  void _ResumeSim( );
+  void _RestoreFreshState( );
+  bool _RunPoint( double rate, double * latency );
+  void _RecordPoint( double rate, bool stable );
+
+  void _WriteCSV( ostream & os ) const;
+  void _WriteJSON( ostream & os ) const;
+
+public:
+
+  SweepTrafficManager( const Configuration &config, const vector<Network *> & net );
+
+  virtual bool Run( );
+
+};
+
+#endif
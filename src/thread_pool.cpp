@@ -0,0 +1,107 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*thread_pool.cpp
+ *
+ *Workers spin (yielding the processor) for a while after finishing a task
+ *before going to sleep, as the network kernel issues three short tasks per
+ *simulated cycle and a futex round trip per phase would dominate runtime.
+ *
+ */
+
+#include "booksim.hpp"
+#include "thread_pool.hpp"
+
+static int const SPIN_LIMIT = 4096;
+
+ThreadPool::ThreadPool(int threads)
+  : _threads(threads), _task(NULL), _shutdown(false), _generation(0), _pending(0)
+{
+  assert(_threads > 0);
+  for(int t = 1; t < _threads; ++t) {
+    _workers.push_back(thread(&ThreadPool::_Worker, this, t));
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    lock_guard<mutex> guard(_lock);
+    _shutdown = true;
+    ++_generation;
+  }
+  _wake.notify_all();
+  for(size_t i = 0; i < _workers.size(); ++i) {
+    _workers[i].join();
+  }
+}
+
+void ThreadPool::Run(Task * task)
+{
+  if(_threads == 1) {
+    task->Execute(0);
+    return;
+  }
+  _task = task;
+  _context.Capture();
+  _pending.store(_threads - 1);
+  {
+    lock_guard<mutex> guard(_lock);
+    ++_generation;
+  }
+  _wake.notify_all();
+  task->Execute(0);
+  while(_pending.load() > 0) {
+    this_thread::yield();
+  }
+}
+
+void ThreadPool::_Worker(int thread)
+{
+  unsigned int seen = 0;
+  while(true) {
+    int spin = 0;
+    while(_generation.load() == seen) {
+      if(spin < SPIN_LIMIT) {
+	++spin;
+	this_thread::yield();
+      } else {
+	unique_lock<mutex> guard(_lock);
+	while(_generation.load() == seen) {
+	  _wake.wait(guard);
+	}
+      }
+    }
+    seen = _generation.load();
+    if(_shutdown) {
+      return;
+    }
+    _context.Install();
+    _task->Execute(thread);
+    --_pending;
+  }
+}
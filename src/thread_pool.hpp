@@ -0,0 +1,82 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef _THREAD_POOL_HPP_
+#define _THREAD_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+#include "sim_context.hpp"
+
+using namespace std;
+
+// Fixed set of worker threads that execute the same task in lock-step.
+// Run() hands the task to every thread (the calling thread acts as thread
+// 0) and only returns once all threads have finished, so consecutive calls
+// are separated by a barrier. The workers take on the simulation state
+// (see sim_context.hpp) of the thread calling Run().
+class ThreadPool {
+
+public:
+
+  class Task {
+  public:
+    virtual ~Task() {}
+    virtual void Execute(int thread) = 0;
+  };
+
+  ThreadPool(int threads);
+  ~ThreadPool();
+
+  inline int NumThreads() const {return _threads;}
+
+  void Run(Task * task);
+
+private:
+
+  int _threads;
+  vector<thread> _workers;
+
+  Task * _task;
+  SimContext _context;
+  bool _shutdown;
+
+  atomic<unsigned int> _generation;
+  atomic<int> _pending;
+
+  mutex _lock;
+  condition_variable _wake;
+
+  void _Worker(int thread);
+
+};
+
+#endif
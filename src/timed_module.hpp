@@ -28,17 +28,53 @@
 #ifndef _TIMED_MODULE_HPP_
 #define _TIMED_MODULE_HPP_
 
+#include <atomic>
+#include <limits>
+
 #include "module.hpp"
+#include "globals.hpp"
 
 class TimedModule : public Module {
 
+  atomic<unsigned long long> * _wake_word;
+  unsigned long long _wake_mask;
+
+  unsigned long long _random_stream;
+
 public:
-  TimedModule(Module * parent, string const & name) : Module(parent, name) {}
+  TimedModule(Module * parent, string const & name) 
+    : Module(parent, name), _wake_word(0), _wake_mask(0), _random_stream(0) {}
   virtual ~TimedModule() {}
   
   virtual void ReadInputs() = 0;
   virtual void Evaluate() = 0;
   virtual void WriteOutputs() = 0;
+
+  // A module that reports being idle at the end of a cycle is not
+  // evaluated again until it is woken up by new input.
+  virtual bool Idle() const { return false; }
+
+  // Earliest cycle in which the module needs to be evaluated, assuming no
+  // new input arrives in the meantime.
+  virtual int NextEventTime() const {
+    return Idle() ? numeric_limits<int>::max() : GetSimTime();
+  }
+
+  void SetWakeFlag(atomic<unsigned long long> * word, unsigned long long mask) {
+    _wake_word = word;
+    _wake_mask = mask;
+  }
+  inline void Wake() {
+    if(_wake_word) {
+      _wake_word->fetch_or(_wake_mask, memory_order_relaxed);
+    }
+  }
+
+  // Random numbers drawn while the module is evaluated come from its own
+  // stream, which the network selects around every phase (see 
+  // random_utils.hpp), so serial and multi-threaded runs draw the same 
+  // values.
+  inline unsigned long long * RandomStream() { return &_random_stream; }
 };
 
 #endif
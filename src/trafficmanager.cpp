@@ -36,9 +36,15 @@
 #include "booksim_config.hpp"
 #include "trafficmanager.hpp"
 #include "batchtrafficmanager.hpp"
+#include "sweeptrafficmanager.hpp"
 #include "random_utils.hpp" 
 #include "vc.hpp"
 #include "packet_reply_info.hpp"
+#include "checkpoint.hpp"
+
+// MSER only judges truncation points that leave at least this many 
+// batches, and the point has to lie in the first half of the batches
+#define MSER_MIN_REMAINING 5
 
 TrafficManager * TrafficManager::New(Configuration const & config,
                                      vector<Network *> const & net)
@@ -49,6 +55,8 @@ TrafficManager * TrafficManager::New(Configuration const & config,
         result = new TrafficManager(config, net);
     } else if(sim_type == "batch") {
         result = new BatchTrafficManager(config, net);
+    } else if(sim_type == "sweep") {
+        result = new SweepTrafficManager(config, net);
     } else {
         cerr << "Unknown simulation type: " << sim_type << endl;
     } 
@@ -71,6 +79,19 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     _subnet[Flit::WRITE_REQUEST] = config.GetInt("write_request_subnet");
     _subnet[Flit::WRITE_REPLY] = config.GetInt("write_reply_subnet");
 
+    _ejected_flits.resize(_subnets, vector<Flit *>(_nodes, (Flit *)NULL));
+
+    // the subnets only interact through the injection and ejection 
+    // bookkeeping below, which stays on the calling thread
+    _subnet_pool = NULL;
+    if ( ( _subnets > 1 ) && ( config.GetInt("parallel_subnets") > 0 ) ) {
+        if ( gWatchOut || gTrace ) {
+            cout << "WARNING: Watch and trace output require serial evaluation; ignoring parallel_subnets." << endl;
+        } else {
+            _subnet_pool = new ThreadPool(_subnets);
+        }
+    }
+
     // ============ Message priorities ============ 
 
     string priority = config.GetStr( "priority" );
@@ -232,6 +253,15 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _injection_process[c] = InjectionProcess::New(injection_process[c], _nodes, _load[c], &config);
     }
 
+    // replies have to be issued as soon as they are due, so read/write
+    // classes are always tested every cycle
+    _skip_ahead.resize(_classes);
+    for(int c = 0; c < _classes; ++c) {
+        _skip_ahead[c] = config.GetInt("skip_ahead_injection") && !_use_read_write[c];
+    }
+    _injection_calendar.resize(_classes);
+    _injection_due.resize(_classes);
+
     // ============ Injection VC states  ============ 
 
     _buf_states.resize(_nodes);
@@ -279,8 +309,13 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
         _partial_packets[s].resize(_classes);
     }
 
-    _total_in_flight_flits.resize(_classes);
-    _measured_in_flight_flits.resize(_classes);
+    _total_in_flight_flits.resize(_classes, 0);
+    _measured_in_flight_flits.resize(_classes, 0);
+    _total_in_flight_ctime.resize(_classes, 0);
+#ifdef TRACK_FLIT_IDS
+    _total_in_flight_ids.resize(_classes);
+    _measured_in_flight_ids.resize(_classes);
+#endif
     _retired_packets.resize(_classes);
 
     _packet_seq_no.resize(_nodes);
@@ -307,6 +342,11 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
       seed = config.GetInt("seed");
     }
     RandomSeed(seed);
+    _seed = seed;
+    // the routers and channels draw from streams of their own
+    for (int i = 0; i < _subnets; ++i) {
+        _net[i]->SeedRandom(RandomStreamSeed(i));
+    }
 
     _measure_latency = (config.GetStr("sim_type") == "latency");
 
@@ -327,6 +367,9 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     }
     _latency_thres.resize(_classes, _latency_thres.back());
 
+    _saturation_periods = config.GetInt( "saturation_periods" );
+    _saturation_thres = config.GetFloat( "saturation_thres" );
+
     _warmup_threshold = config.GetFloatArray( "warmup_thres" );
     if(_warmup_threshold.empty()) {
         _warmup_threshold.push_back(config.GetFloat("warmup_thres"));
@@ -351,11 +394,66 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
     }
     _acc_stopping_threshold.resize(_classes, _acc_stopping_threshold.back());
 
+    _stopping_ci = config.GetFloatArray( "stopping_ci" );
+    if(_stopping_ci.empty()) {
+        _stopping_ci.push_back(config.GetFloat("stopping_ci"));
+    }
+    _stopping_ci.resize(_classes, _stopping_ci.back());
+    // classes without a confidence interval target still have to pass the 
+    // change thresholds in three consecutive sample periods
+    _ci_stopping = false;
+    _converged_periods = 1;
+    for(int c = 0; c < _classes; ++c) {
+        if(_measure_stats[c]) {
+            if(_stopping_ci[c] >= 0.0) {
+                _ci_stopping = true;
+            } else {
+                _converged_periods = 3;
+            }
+        }
+    }
+    _stopping_ci_level = config.GetFloat( "stopping_ci_level" );
+    if((_stopping_ci_level <= 0.0) || (_stopping_ci_level >= 1.0)) {
+        Error("stopping_ci_level must lie between 0 and 1.");
+    }
+    _stopping_ci_batches = config.GetInt( "stopping_ci_batches" );
+    if(_stopping_ci_batches < 2) {
+        Error("stopping_ci_batches must be at least 2.");
+    }
+
+    _warmup_mser = config.GetInt( "warmup_mser" );
+    if((_warmup_mser > 0) && _pair_stats) {
+        Error("warmup_mser does not support pair_stats.");
+    }
+    // MSER cannot end the warm up before it has seen twice the minimum 
+    // number of batches; give it as long again to find a truncation point
+    _warmup_max_samples = _max_samples;
+    if(_warmup_mser > 0) {
+        _warmup_max_samples = max(_max_samples, 4 * MSER_MIN_REMAINING * _warmup_mser);
+    }
+
     _include_queuing = config.GetInt( "include_queuing" );
 
     _print_csv_results = config.GetInt( "print_csv_results" );
     _deadlock_warn_timeout = config.GetInt( "deadlock_warn_timeout" );
 
+    // the viewer trace expects a line for every cycle
+    _fast_forward = (config.GetInt( "fast_forward" ) > 0) && !gTrace;
+
+    _checkpoint_out = config.GetStr( "checkpoint_out" );
+    _checkpoint_at = config.GetInt( "checkpoint_at" );
+    _checkpoint_exit = (config.GetInt( "checkpoint_exit" ) > 0);
+    _checkpoint_saved = false;
+    _checkpoint_in = config.GetStr( "checkpoint_in" );
+    _checkpoint_reseed = (config.GetInt( "checkpoint_reseed" ) > 0);
+    _resuming = false;
+
+    _sim = 0;
+    _total_phases = 0;
+    _warmup_phases = 0;
+    _converged = 0;
+    _clear_last = false;
+
     string watch_file = config.GetStr( "watch_file" );
     if((watch_file != "") && (watch_file != "-")) {
         _LoadWatchList(watch_file);
@@ -479,6 +577,11 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
   
     _hop_stats.resize(_classes);
     _overall_hop_stats.resize(_classes, 0.0);
+
+    _overall_plat_ci.resize(_classes, 0.0);
+    _overall_accepted_ci.resize(_classes, 0.0);
+    _batch_plat.resize(_classes);
+    _batch_accepted.resize(_classes);
   
     _sent_packets.resize(_classes);
     _overall_min_sent_packets.resize(_classes, 0.0);
@@ -589,6 +692,10 @@ TrafficManager::TrafficManager( const Configuration &config, const vector<Networ
 TrafficManager::~TrafficManager( )
 {
 
+    if ( _subnet_pool ) delete _subnet_pool;
+
+    _ClearWarmupRecord( );
+
     for ( int source = 0; source < _nodes; ++source ) {
         for ( int subnet = 0; subnet < _subnets; ++subnet ) {
             delete _buf_states[source][subnet];
@@ -644,12 +751,19 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
 {
     _deadlock_timer = 0;
 
-    assert(_total_in_flight_flits[f->cl].count(f->id) > 0);
-    _total_in_flight_flits[f->cl].erase(f->id);
+    assert(_total_in_flight_flits[f->cl] > 0);
+    --_total_in_flight_flits[f->cl];
+    _total_in_flight_ctime[f->cl] -= f->cold().ctime;
+#ifdef TRACK_FLIT_IDS
+    _total_in_flight_ids[f->cl].Erase(f->id);
+#endif
   
     if(f->record) {
-        assert(_measured_in_flight_flits[f->cl].count(f->id) > 0);
-        _measured_in_flight_flits[f->cl].erase(f->id);
+        assert(_measured_in_flight_flits[f->cl] > 0);
+        --_measured_in_flight_flits[f->cl];
+#ifdef TRACK_FLIT_IDS
+        _measured_in_flight_ids[f->cl].Erase(f->id);
+#endif
     }
 
     if ( f->watch ) { 
@@ -660,7 +774,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
                    << ", src = " << f->src 
                    << ", dest = " << f->dest
                    << ", hops = " << f->hops
-                   << ", flat = " << f->atime - f->itime
+                   << ", flat = " << f->cold().atime - f->cold().itime
                    << ")." << endl;
     }
 
@@ -671,11 +785,11 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
     }
   
     if((_slowest_flit[f->cl] < 0) ||
-       (_flat_stats[f->cl]->Max() < (f->atime - f->itime)))
+       (_flat_stats[f->cl]->Max() < (f->cold().atime - f->cold().itime)))
         _slowest_flit[f->cl] = f->id;
-    _flat_stats[f->cl]->AddSample( f->atime - f->itime);
+    _flat_stats[f->cl]->AddSample( f->cold().atime - f->cold().itime);
     if(_pair_stats){
-        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - f->itime );
+        _pair_flat[f->cl][f->src*_nodes+dest]->AddSample( f->cold().atime - f->cold().itime );
     }
       
     if ( f->tail ) {
@@ -683,10 +797,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         if(f->head) {
             head = f;
         } else {
-            map<int, Flit *>::iterator iter = _retired_packets[f->cl].find(f->pid);
-            assert(iter != _retired_packets[f->cl].end());
-            head = iter->second;
-            _retired_packets[f->cl].erase(iter);
+            head = _retired_packets[f->cl].Erase(f->pid);
             assert(head->head);
             assert(f->pid == head->pid);
         }
@@ -694,9 +805,9 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
             *gWatchOut << GetSimTime() << " | "
                        << "node" << dest << " | "
                        << "Retiring packet " << f->pid 
-                       << " (plat = " << f->atime - head->ctime
-                       << ", nlat = " << f->atime - head->itime
-                       << ", frag = " << (f->atime - head->atime) - (f->id - head->id) // NB: In the spirit of solving problems using ugly hacks, we compute the packet length by taking advantage of the fact that the IDs of flits within a packet are contiguous.
+                       << " (plat = " << f->cold().atime - head->cold().ctime
+                       << ", nlat = " << f->cold().atime - head->cold().itime
+                       << ", frag = " << (f->cold().atime - head->cold().atime) - (f->id - head->id) // NB: In the spirit of solving problems using ugly hacks, we compute the packet length by taking advantage of the fact that the IDs of flits within a packet are contiguous.
                        << ", src = " << head->src 
                        << ", dest = " << head->dest
                        << ")." << endl;
@@ -706,7 +817,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
         if (f->type == Flit::READ_REQUEST || f->type == Flit::WRITE_REQUEST) {
             PacketReplyInfo* rinfo = PacketReplyInfo::New();
             rinfo->source = f->src;
-            rinfo->time = f->atime;
+            rinfo->time = f->cold().atime;
             rinfo->record = f->record;
             rinfo->type = f->type;
             _repliesPending[dest].push_back(rinfo);
@@ -726,15 +837,15 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
             _hop_stats[f->cl]->AddSample( f->hops );
 
             if((_slowest_packet[f->cl] < 0) ||
-               (_plat_stats[f->cl]->Max() < (f->atime - head->itime)))
+               (_plat_stats[f->cl]->Max() < (f->cold().atime - head->cold().itime)))
                 _slowest_packet[f->cl] = f->pid;
-            _plat_stats[f->cl]->AddSample( f->atime - head->ctime);
-            _nlat_stats[f->cl]->AddSample( f->atime - head->itime);
-            _frag_stats[f->cl]->AddSample( (f->atime - head->atime) - (f->id - head->id) );
+            _plat_stats[f->cl]->AddSample( f->cold().atime - head->cold().ctime);
+            _nlat_stats[f->cl]->AddSample( f->cold().atime - head->cold().itime);
+            _frag_stats[f->cl]->AddSample( (f->cold().atime - head->cold().atime) - (f->id - head->id) );
    
             if(_pair_stats){
-                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->ctime );
-                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->atime - head->itime );
+                _pair_plat[f->cl][f->src*_nodes+dest]->AddSample( f->cold().atime - head->cold().ctime );
+                _pair_nlat[f->cl][f->src*_nodes+dest]->AddSample( f->cold().atime - head->cold().itime );
             }
         }
     
@@ -745,7 +856,7 @@ void TrafficManager::_RetireFlit( Flit *f, int dest )
     }
   
     if(f->head && !f->tail) {
-        _retired_packets[f->cl].insert(make_pair(f->pid, f));
+        _retired_packets[f->cl].Insert(f->pid, f);
     } else {
         f->Free();
     }
@@ -835,7 +946,10 @@ void TrafficManager::_GeneratePacket( int source, int stype,
         Error( err.str( ) );
     }
 
+    // during an MSER warmup, any period may turn out to be part of the 
+    // steady state
     if ( ( _sim_state == running ) ||
+         ( ( _sim_state == warming_up ) && ( _warmup_mser > 0 ) ) ||
          ( ( _sim_state == draining ) && ( time < _drain_time ) ) ) {
         record = _measure_stats[cl];
     }
@@ -852,81 +966,189 @@ void TrafficManager::_GeneratePacket( int source, int stype,
                    << "." << endl;
     }
   
+    sQueuedPacket p;
+    p.pid = pid;
+    p.id = _cur_id;
+    p.size = size;
+    p.next = 0;
+    p.flit = NULL;
+    p.ctime = time;
+    p.dest = packet_destination;
+    p.subnetwork = subnetwork;
+    switch( _pri_type ) {
+    case class_based:
+        p.pri = _class_priority[cl];
+        assert(p.pri >= 0);
+        break;
+    case age_based:
+        p.pri = numeric_limits<int>::max() - time;
+        assert(p.pri >= 0);
+        break;
+    case sequence_based:
+        p.pri = numeric_limits<int>::max() - _packet_seq_no[source];
+        assert(p.pri >= 0);
+        break;
+    default:
+        p.pri = 0;
+    }
+    p.type = packet_type;
+    p.record = record;
+    p.watch = watch;
+
     for ( int i = 0; i < size; ++i ) {
-        Flit * f  = Flit::New();
-        f->id     = _cur_id++;
+        int const id = _cur_id++;
         assert(_cur_id);
-        f->pid    = pid;
-        f->watch  = watch | (gWatchOut && (_flits_to_watch.count(f->id) > 0));
-        f->subnetwork = subnetwork;
-        f->src    = source;
-        f->ctime  = time;
-        f->record = record;
-        f->cl     = cl;
-
-        _total_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+
+        ++_total_in_flight_flits[cl];
+        _total_in_flight_ctime[cl] += time;
+#ifdef TRACK_FLIT_IDS
+        _total_in_flight_ids[cl].Insert(id, true);
+#endif
         if(record) {
-            _measured_in_flight_flits[f->cl].insert(make_pair(f->id, f));
+            ++_measured_in_flight_flits[cl];
+#ifdef TRACK_FLIT_IDS
+            _measured_in_flight_ids[cl].Insert(id, true);
+#endif
         }
     
         if(gTrace){
-            cout<<"New Flit "<<f->src<<endl;
-        }
-        f->type = packet_type;
-
-        if ( i == 0 ) { // Head flit
-            f->head = true;
-            //packets are only generated to nodes smaller or equal to limit
-            f->dest = packet_destination;
-        } else {
-            f->head = false;
-            f->dest = -1;
+            cout<<"New Flit "<<source<<endl;
         }
-        switch( _pri_type ) {
-        case class_based:
-            f->pri = _class_priority[cl];
-            assert(f->pri >= 0);
-            break;
-        case age_based:
-            f->pri = numeric_limits<int>::max() - time;
-            assert(f->pri >= 0);
-            break;
-        case sequence_based:
-            f->pri = numeric_limits<int>::max() - _packet_seq_no[source];
-            assert(f->pri >= 0);
-            break;
-        default:
-            f->pri = 0;
-        }
-        if ( i == ( size - 1 ) ) { // Tail flit
-            f->tail = true;
-        } else {
-            f->tail = false;
-        }
-    
-        f->vc  = -1;
 
-        if ( f->watch ) { 
+        if ( watch || (gWatchOut && (_flits_to_watch.count(id) > 0)) ) { 
             *gWatchOut << GetSimTime() << " | "
                        << "node" << source << " | "
-                       << "Enqueuing flit " << f->id
-                       << " (packet " << f->pid
+                       << "Enqueuing flit " << id
+                       << " (packet " << pid
                        << ") at time " << time
                        << "." << endl;
         }
+    }
 
-        _partial_packets[source][cl].push_back( f );
+    list<sQueuedPacket> & pp = _partial_packets[source][cl];
+    pp.push_back( p );
+    if ( pp.size() == 1 ) {
+        _NewFlit( pp.front(), source, cl );
     }
 }
 
-void TrafficManager::_Inject(){
+Flit * TrafficManager::_NewFlit( sQueuedPacket & p, int source, int cl )
+{
+    assert(p.next < p.size);
+    int const i = p.next++;
+
+    Flit * f  = Flit::New();
+    f->id     = p.id + i;
+    f->pid    = p.pid;
+    f->watch  = p.watch | (gWatchOut && (_flits_to_watch.count(f->id) > 0));
+    f->subnetwork = p.subnetwork;
+    f->src    = source;
+    f->cold().ctime  = p.ctime;
+    f->record = p.record;
+    f->cl     = cl;
+    f->type   = p.type;
+    f->head   = ( i == 0 );
+    f->tail   = ( i == ( p.size - 1 ) );
+    //packets are only generated to nodes smaller or equal to limit
+    f->dest   = f->head ? p.dest : -1;
+    f->pri    = p.pri;
+    f->vc     = -1;
+
+    p.flit = f;
+    return f;
+}
+
+// returns the cycle after the given one in which the source injects next
+int TrafficManager::_NextInjection( int source, int cl, int time )
+{
+    int const skip = _injection_process[cl]->skip(source);
+    if ( skip >= numeric_limits<int>::max() - time ) {
+        return numeric_limits<int>::max();
+    }
+    return time + skip;
+}
+
+void TrafficManager::_ScheduleInjections( )
+{
+    for ( int c = 0; c < _classes; ++c ) {
+        if ( !_skip_ahead[c] ) {
+            continue;
+        }
+        _injection_calendar[c] = priority_queue<pair<int, int>, vector<pair<int, int> >, 
+                                                greater<pair<int, int> > >();
+        _injection_due[c].clear();
+        for ( int s = 0; s < _nodes; ++s ) {
+            _qtime[s][c] = _NextInjection( s, c, _time );
+            if ( _qtime[s][c] < numeric_limits<int>::max() ) {
+                _injection_calendar[c].push( make_pair( _qtime[s][c], s ) );
+            }
+        }
+    }
+}
+
+// generates packets for the sources of a skip-ahead class whose injection
+// cycle has come and whose source queue is empty
+void TrafficManager::_InjectSkipAhead( int cl )
+{
+    priority_queue<pair<int, int>, vector<pair<int, int> >, 
+                   greater<pair<int, int> > > & calendar = _injection_calendar[cl];
+    list<int> & due = _injection_due[cl];
+
+    while ( !calendar.empty() && ( calendar.top().first <= _time ) ) {
+        due.push_back( calendar.top().second );
+        calendar.pop();
+    }
+
+    list<int>::iterator iter = due.begin();
+    while ( iter != due.end() ) {
+        int const source = *iter;
+        if ( !_partial_packets[source][cl].empty() ) {
+            ++iter;
+            continue;
+        }
+        ++_requestsOutstanding[source];
+        ++_packet_seq_no[source];
+        _GeneratePacket( source, 1, cl, 
+                         _include_queuing==1 ? 
+                         _qtime[source][cl] : _time );
+        _qtime[source][cl] = _NextInjection( source, cl, _qtime[source][cl] + 1 );
+        if ( _qtime[source][cl] <= _time ) {
+            // still backlogged; at most one packet per cycle
+            ++iter;
+        } else {
+            if ( _qtime[source][cl] < numeric_limits<int>::max() ) {
+                calendar.push( make_pair( _qtime[source][cl], source ) );
+            }
+            iter = due.erase( iter );
+        }
+    }
+}
+
+// returns true if any source queue was found to be drained
+bool TrafficManager::_Inject(){
+
+    bool drained = false;
+
+    bool tested = false;
+    for ( int c = 0; c < _classes; ++c ) {
+        if ( _skip_ahead[c] ) {
+            _InjectSkipAhead( c );
+        } else {
+            tested = true;
+        }
+    }
+
+    if ( !tested && ( _sim_state != draining ) ) {
+        return false;
+    }
 
     for ( int input = 0; input < _nodes; ++input ) {
         for ( int c = 0; c < _classes; ++c ) {
             // Potentially generate packets for any (input,class)
             // that is currently empty
             if ( _partial_packets[input][c].empty() ) {
-                bool generated = false;
+                // skip-ahead classes were already handled above
+                bool generated = _skip_ahead[c];
                 while( !generated && ( _qtime[input][c] <= _time ) ) {
                     int stype = _IssuePacket( input, c );
 	  
@@ -943,68 +1165,213 @@ void TrafficManager::_Inject(){
                 }
 	
                 if ( ( _sim_state == draining ) && 
-                     ( _qtime[input][c] > _drain_time ) ) {
+                     ( _qtime[input][c] > _drain_time ) &&
+                     !_qdrained[input][c] ) {
                     _qdrained[input][c] = true;
+                    drained = true;
                 }
             }
         }
     }
+    return drained;
 }
 
 void TrafficManager::_Step( )
+{
+    _CheckDeadlock( );
+    _SimulateCycle( );
+}
+
+void TrafficManager::_CheckDeadlock( )
 {
     bool flits_in_flight = false;
     for(int c = 0; c < _classes; ++c) {
-        flits_in_flight |= !_total_in_flight_flits[c].empty();
+        flits_in_flight |= (_total_in_flight_flits[c] > 0);
     }
     if(flits_in_flight && (_deadlock_timer++ >= _deadlock_warn_timeout)){
         _deadlock_timer = 0;
         cout << "WARNING: Possible network deadlock.\n";
     }
+}
 
-    vector<map<int, Flit *> > flits(_subnets);
-  
+/* Simulates at least one and at most max_cycles cycles and returns the
+ * number of cycles simulated. As long as all source queues are empty and
+ * no module in the network is due before a later cycle, the only things
+ * that can happen in a cycle are the deadlock check and the injection
+ * processes deciding whether to generate a packet. Such cycles are run by
+ * calling just those two, so the network is not evaluated, but every source
+ * is still tested once per cycle; once a packet is generated, the rest of
+ * that cycle is simulated normally. The injection processes are thus queried
+ * in exactly the same order as when stepping cycle by cycle. Only if no
+ * source has to be tested every cycle (while draining, or with skip-ahead
+ * injection for every class) are the cycles up to the next network event or
+ * scheduled injection jumped over in one go.
+ */
+int TrafficManager::_Advance( int max_cycles )
+{
+    assert(max_cycles > 0);
+
+    if ( !_fast_forward ) {
+        _Step( );
+        return 1;
+    }
+
+    int next = numeric_limits<int>::max();
     for ( int subnet = 0; subnet < _subnets; ++subnet ) {
-        for ( int n = 0; n < _nodes; ++n ) {
-            Flit * const f = _net[subnet]->ReadFlit( n );
-            if ( f ) {
-                if(f->watch) {
-                    *gWatchOut << GetSimTime() << " | "
-                               << "node" << n << " | "
-                               << "Ejecting flit " << f->id
-                               << " (packet " << f->pid << ")"
-                               << " from VC " << f->vc
-                               << "." << endl;
-                }
-                flits[subnet].insert(make_pair(n, f));
-                if((_sim_state == warming_up) || (_sim_state == running)) {
+        next = min(next, _net[subnet]->NextEventTime( ));
+        if ( next <= _time ) {
+            _Step( );
+            return 1;
+        }
+    }
+
+    for ( int n = 0; n < _nodes; ++n ) {
+        for ( int c = 0; c < _classes; ++c ) {
+            if ( !_partial_packets[n][c].empty() ) {
+                _Step( );
+                return 1;
+            }
+        }
+    }
+
+    if ( _empty_network && ( next == numeric_limits<int>::max() ) ) {
+        // nothing is scheduled to bound a jump, e.g. while waiting for the
+        // last credits; fall back to stepping
+        _Step( );
+        return 1;
+    }
+
+    bool skip = _empty_network;
+    int until = next;
+    if ( !skip && ( _sim_state != draining ) ) {
+        skip = true;
+        for ( int c = 0; c < _classes; ++c ) {
+            if ( !_skip_ahead[c] || !_injection_due[c].empty() ) {
+                skip = false;
+                break;
+            }
+            if ( !_injection_calendar[c].empty() ) {
+                until = min(until, _injection_calendar[c].top().first);
+            }
+        }
+    }
+    if ( skip && ( until > _time ) && ( until < numeric_limits<int>::max() ) ) {
+        int const cycles = min(max_cycles, until - _time);
+        assert(cycles > 0);
+        for ( int i = 0; i < cycles; ++i ) {
+            _CheckDeadlock( );
+        }
+        _time += cycles;
+        return cycles;
+    }
+
+    int cycles = 0;
+    while ( ( cycles < max_cycles ) && ( _time < next ) ) {
+        ++cycles;
+        _CheckDeadlock( );
+        if ( !_empty_network ) {
+            int const pid = _cur_pid;
+            bool const drained = _Inject( );
+            if ( _cur_pid != pid ) {
+                // the sources have already been served this cycle
+                _SimulateCycle( false );
+                break;
+            }
+            if ( drained ) {
+                // the caller may be waiting for the sources to drain
+                ++_time;
+                break;
+            }
+        }
+        ++_time;
+        assert(_time);
+    }
+    assert(cycles > 0);
+    return cycles;
+}
+
+class TrafficManager::SubnetTask : public ThreadPool::Task {
+    TrafficManager * _tm;
+    void (TrafficManager::*_phase)( int );
+public:
+    SubnetTask( TrafficManager * tm, void (TrafficManager::*phase)( int ) )
+        : _tm(tm), _phase(phase) {}
+    void Execute( int thread ) {
+        (_tm->*_phase)(thread);
+    }
+};
+
+void TrafficManager::_RunSubnets( void (TrafficManager::*phase)( int ) )
+{
+    assert(_subnet_pool);
+    SubnetTask task(this, phase);
+    _subnet_pool->Run(&task);
+}
+
+// Collects the flits and credits ejected from one subnet; everything here 
+// is private to the subnet, so subnets can be read concurrently.
+void TrafficManager::_ReadSubnet( int subnet )
+{
+    for ( int n = 0; n < _nodes; ++n ) {
+        Flit * const f = _net[subnet]->ReadFlit( n );
+        if ( f && f->watch ) {
+            *gWatchOut << GetSimTime() << " | "
+                       << "node" << n << " | "
+                       << "Ejecting flit " << f->id
+                       << " (packet " << f->pid << ")"
+                       << " from VC " << f->vc
+                       << "." << endl;
+        }
+        _ejected_flits[subnet][n] = f;
+
+        Credit * const c = _net[subnet]->ReadCredit( n );
+        if ( c ) {
+#ifdef TRACK_FLOWS
+            for(int vc = c->FirstVC(); vc >= 0; vc = c->NextVC(vc)) {
+                assert(!_outstanding_classes[n][subnet][vc].empty());
+                int cl = _outstanding_classes[n][subnet][vc].front();
+                _outstanding_classes[n][subnet][vc].pop();
+                assert(_outstanding_credits[cl][subnet][n] > 0);
+                --_outstanding_credits[cl][subnet][n];
+            }
+#endif
+            _buf_states[n][subnet]->ProcessCredit(c);
+            c->Free();
+        }
+    }
+    _net[subnet]->ReadInputs( );
+}
+
+void TrafficManager::_EvaluateSubnet( int subnet )
+{
+    _net[subnet]->Evaluate( );
+    _net[subnet]->WriteOutputs( );
+}
+
+void TrafficManager::_SimulateCycle( bool inject )
+{
+    if ( _subnet_pool ) {
+        _RunSubnets( &TrafficManager::_ReadSubnet );
+    }
+
+    for ( int subnet = 0; subnet < _subnets; ++subnet ) {
+        if ( !_subnet_pool ) {
+            _ReadSubnet( subnet );
+        }
+        if((_sim_state == warming_up) || (_sim_state == running)) {
+            for ( int n = 0; n < _nodes; ++n ) {
+                Flit * const f = _ejected_flits[subnet][n];
+                if ( f ) {
                     ++_accepted_flits[f->cl][n];
                     if(f->tail) {
                         ++_accepted_packets[f->cl][n];
                     }
                 }
             }
-
-            Credit * const c = _net[subnet]->ReadCredit( n );
-            if ( c ) {
-#ifdef TRACK_FLOWS
-                for(set<int>::const_iterator iter = c->vc.begin(); iter != c->vc.end(); ++iter) {
-                    int const vc = *iter;
-                    assert(!_outstanding_classes[n][subnet][vc].empty());
-                    int cl = _outstanding_classes[n][subnet][vc].front();
-                    _outstanding_classes[n][subnet][vc].pop();
-                    assert(_outstanding_credits[cl][subnet][n] > 0);
-                    --_outstanding_credits[cl][subnet][n];
-                }
-#endif
-                _buf_states[n][subnet]->ProcessCredit(c);
-                c->Free();
-            }
         }
-        _net[subnet]->ReadInputs( );
     }
   
-    if ( !_empty_network ) {
+    if ( inject && !_empty_network ) {
         _Inject();
     }
 
@@ -1021,10 +1388,10 @@ void TrafficManager::_Step( )
             int class_limit = _classes;
 
             if(_hold_switch_for_packet) {
-                list<Flit *> const & pp = _partial_packets[n][last_class];
-                if(!pp.empty() && !pp.front()->head && 
-                   !dest_buf->IsFullFor(pp.front()->vc)) {
-                    f = pp.front();
+                list<sQueuedPacket> const & pp = _partial_packets[n][last_class];
+                if(!pp.empty() && !pp.front().flit->head && 
+                   !dest_buf->IsFullFor(pp.front().flit->vc)) {
+                    f = pp.front().flit;
                     assert(f->vc == _last_vc[n][subnet][last_class]);
 
                     // if we're holding the connection, we don't need to check that class 
@@ -1037,13 +1404,13 @@ void TrafficManager::_Step( )
 
                 int const c = (last_class + i) % _classes;
 
-                list<Flit *> const & pp = _partial_packets[n][c];
+                list<sQueuedPacket> const & pp = _partial_packets[n][c];
 
                 if(pp.empty()) {
                     continue;
                 }
 
-                Flit * const cf = pp.front();
+                Flit * const cf = pp.front().flit;
                 assert(cf);
                 assert(cf->cl == c);
 	
@@ -1059,7 +1426,7 @@ void TrafficManager::_Step( )
 	  
                     OutputSet route_set;
                     _rf(NULL, cf, -1, &route_set, true);
-                    set<OutputSet::sSetElement> const & os = route_set.GetSet();
+                    OutputSet::ElementList const & os = route_set.GetSet();
                     assert(os.size() == 1);
                     OutputSet::sSetElement const & se = *os.begin();
                     assert(se.output_port == -1);
@@ -1077,7 +1444,7 @@ void TrafficManager::_Step( )
                         // first hop, we have to temporarily set cf's VC to be non-negative 
                         // in order to avoid seting of an assertion in the routing function.
                         cf->vc = vc_start;
-                        _rf(router, cf, in_channel, &cf->la_route_set, false);
+                        _rf(router, cf, in_channel, &cf->cold().la_route_set, false);
                         cf->vc = -1;
 
                         if(cf->watch) {
@@ -1086,7 +1453,7 @@ void TrafficManager::_Step( )
                                        << "Generating lookahead routing info for flit " << cf->id
                                        << " (NOQ)." << endl;
                         }
-                        set<OutputSet::sSetElement> const sl = cf->la_route_set.GetSet();
+                        OutputSet::ElementList const & sl = cf->cold().la_route_set.GetSet();
                         assert(sl.size() == 1);
                         int next_output = sl.begin()->output_port;
                         vc_count /= router->NumOutputs();
@@ -1165,7 +1532,7 @@ void TrafficManager::_Step( )
                             const Router * router = inject->GetSink();
                             assert(router);
                             int in_channel = inject->GetSinkPort();
-                            _rf(router, f, in_channel, &f->la_route_set, false);
+                            _rf(router, f, in_channel, &f->cold().la_route_set, false);
                             if(f->watch) {
                                 *gWatchOut << GetSimTime() << " | "
                                            << "node" << n << " | "
@@ -1179,7 +1546,7 @@ void TrafficManager::_Step( )
                                        << " (NOQ)." << endl;
                         }
                     } else {
-                        f->la_route_set.Clear();
+                        f->cold().la_route_set.Clear();
                     }
 
                     dest_buf->TakeBuffer(f->vc);
@@ -1188,7 +1555,17 @@ void TrafficManager::_Step( )
 	
                 _last_class[n][subnet] = c;
 
-                _partial_packets[n][c].pop_front();
+                list<sQueuedPacket> & pp = _partial_packets[n][c];
+                if(f->tail) {
+                    pp.pop_front();
+                    if(!pp.empty()) {
+                        _NewFlit(pp.front(), n, c);
+                    }
+                } else {
+                    // Pass VC "back"
+                    Flit * const nf = _NewFlit(pp.front(), n, c);
+                    nf->vc = f->vc;
+                }
 
 #ifdef TRACK_FLOWS
                 ++_outstanding_credits[c][subnet][n];
@@ -1211,14 +1588,8 @@ void TrafficManager::_Step( )
                                << " with priority " << f->pri
                                << "." << endl;
                 }
-                f->itime = _time;
+                f->cold().itime = _time;
 
-                // Pass VC "back"
-                if(!_partial_packets[n][c].empty() && !f->tail) {
-                    Flit * const nf = _partial_packets[n][c].front();
-                    nf->vc = f->vc;
-                }
-	
                 if((_sim_state == warming_up) || (_sim_state == running)) {
                     ++_sent_flits[c][n];
                     if(f->head) {
@@ -1238,11 +1609,10 @@ void TrafficManager::_Step( )
 
     for(int subnet = 0; subnet < _subnets; ++subnet) {
         for(int n = 0; n < _nodes; ++n) {
-            map<int, Flit *>::const_iterator iter = flits[subnet].find(n);
-            if(iter != flits[subnet].end()) {
-                Flit * const f = iter->second;
+            Flit * const f = _ejected_flits[subnet][n];
+            if(f) {
 
-                f->atime = _time;
+                f->cold().atime = _time;
                 if(f->watch) {
                     *gWatchOut << GetSimTime() << " | "
                                << "node" << n << " | "
@@ -1251,7 +1621,7 @@ void TrafficManager::_Step( )
                                << "." << endl;
                 }
                 Credit * const c = Credit::New();
-                c->vc.insert(f->vc);
+                c->AddVC(f->vc);
                 _net[subnet]->WriteCredit(c, n);
 	
 #ifdef TRACK_FLOWS
@@ -1261,9 +1631,13 @@ void TrafficManager::_Step( )
                 _RetireFlit(f, n);
             }
         }
-        flits[subnet].clear();
-        _net[subnet]->Evaluate( );
-        _net[subnet]->WriteOutputs( );
+        if ( !_subnet_pool ) {
+            _EvaluateSubnet( subnet );
+        }
+    }
+
+    if ( _subnet_pool ) {
+        _RunSubnets( &TrafficManager::_EvaluateSubnet );
     }
 
     ++_time;
@@ -1278,7 +1652,7 @@ bool TrafficManager::_PacketsOutstanding( ) const
 {
     for ( int c = 0; c < _classes; ++c ) {
         if ( _measure_stats[c] ) {
-            if ( _measured_in_flight_flits[c].empty() ) {
+            if ( _measured_in_flight_flits[c] == 0 ) {
 	
                 for ( int s = 0; s < _nodes; ++s ) {
                     if ( !_qdrained[s][c] ) {
@@ -1291,7 +1665,7 @@ bool TrafficManager::_PacketsOutstanding( ) const
                 }
             } else {
 #ifdef DEBUG_DRAIN
-                cout << "in flight = " << _measured_in_flight_flits[c].size() << endl;
+                cout << "in flight = " << _measured_in_flight_flits[c] << endl;
 #endif
                 return true;
             }
@@ -1336,7 +1710,13 @@ void TrafficManager::_ClearStats( )
         }
         _hop_stats[c]->Clear();
 
+        _batch_plat[c].clear();
+        _batch_accepted[c].clear();
     }
+    _batch_plat_sum.assign(_classes, 0.0);
+    _batch_plat_count.assign(_classes, 0);
+    _batch_accepted_count.assign(_classes, 0);
+    _batch_time = _time;
 
     _reset_time = _time;
 }
@@ -1380,61 +1760,351 @@ void TrafficManager::_ComputeStats( const vector<int> & stats, int *sum, int *mi
     }
 }
 
-void TrafficManager::_DisplayRemaining( ostream & os ) const 
+// probability that |T| < t for Student's t distribution with dof degrees
+// of freedom (Abramowitz and Stegun 26.7.3 and 26.7.4)
+static double StudentTProbability( double t, int dof )
+{
+    double const theta = atan(t / sqrt((double)dof));
+    double const c2 = cos(theta) * cos(theta);
+    double term = 1.0;
+    double sum = 1.0;
+    if(dof % 2) {
+        if(dof == 1) {
+            return 2.0 * theta / M_PI;
+        }
+        for(int k = 3; k <= dof - 2; k += 2) {
+            term *= c2 * (double)(k - 1) / (double)k;
+            sum += term;
+        }
+        return 2.0 * (theta + sin(theta) * cos(theta) * sum) / M_PI;
+    } else {
+        for(int k = 2; k <= dof - 2; k += 2) {
+            term *= c2 * (double)(k - 1) / (double)k;
+            sum += term;
+        }
+        return sin(theta) * sum;
+    }
+}
+
+// the t for which |T| < t with the given probability, by bisection
+static double StudentTQuantile( double level, int dof )
+{
+    double lo = 0.0;
+    double hi = 1.0;
+    while(StudentTProbability(hi, dof) < level) {
+        lo = hi;
+        hi *= 2.0;
+    }
+    for(int i = 0; i < 60; ++i) {
+        double const mid = 0.5 * (lo + hi);
+        if(StudentTProbability(mid, dof) < level) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0.5 * (lo + hi);
+}
+
+// half-width of the confidence interval for the mean of the batch means, 
+// which are treated as independent samples
+double TrafficManager::_BatchHalfWidth( const vector<double> & batches, double *mean ) const
+{
+    int const n = batches.size();
+    double sum = 0.0;
+    for(int i = 0; i < n; ++i) {
+        sum += batches[i];
+    }
+    double const avg = (n > 0) ? (sum / (double)n) : 0.0;
+    if(mean) {
+        *mean = avg;
+    }
+    if(n < 2) {
+        return numeric_limits<double>::infinity();
+    }
+    double var = 0.0;
+    for(int i = 0; i < n; ++i) {
+        var += (batches[i] - avg) * (batches[i] - avg);
+    }
+    var /= (double)(n - 1);
+    double const t = StudentTQuantile(_stopping_ci_level, n - 1);
+    return t * sqrt(var / (double)n);
+}
+
+// MSER-m: the observations are averaged in batches of m, and the number of
+// batches d to drop is the one that minimizes the squared deviation of the 
+// remaining batches from their mean, divided by the square of their number.
+// The last batches are too few for this to be meaningful, and if the 
+// minimum lies in the second half of the series, it has not yet settled
+// down; both cases return -1.
+static int MserTruncation( const vector<double> & x, int m )
+{
+    int const min_remaining = MSER_MIN_REMAINING;
+    int const n = x.size() / m;
+    if(n < 2 * min_remaining) {
+        return -1;
+    }
+    vector<double> batches(n, 0.0);
+    for(int i = 0; i < n * m; ++i) {
+        batches[i / m] += x[i] / (double)m;
+    }
+    double sum = 0.0;
+    double squared_sum = 0.0;
+    double best = numeric_limits<double>::infinity();
+    int best_d = -1;
+    for(int d = n - 1; d >= 0; --d) {
+        sum += batches[d];
+        squared_sum += batches[d] * batches[d];
+        double const k = (double)(n - d);
+        if(n - d >= min_remaining) {
+            double const mser = (squared_sum - sum * sum / k) / (k * k);
+            if(mser <= best) {
+                best = mser;
+                best_d = d;
+            }
+        }
+    }
+    return (2 * best_d < n) ? best_d : -1;
+}
+
+// the statistics kept for each class and sample period
+void TrafficManager::_PeriodStats( int c, vector<Stats *> & stats, vector<vector<int> *> & counts )
+{
+    Stats * const s[] = { _plat_stats[c], _nlat_stats[c], _flat_stats[c],
+                          _frag_stats[c], _hop_stats[c] };
+    stats.assign(s, s + sizeof(s) / sizeof(s[0]));
+    vector<int> * const n[] = { &_sent_packets[c], &_accepted_packets[c],
+                                &_sent_flits[c], &_accepted_flits[c]
+#ifdef TRACK_STALLS
+                                , &_buffer_busy_stalls[c], &_buffer_conflict_stalls[c],
+                                &_buffer_full_stalls[c], &_buffer_reserved_stalls[c],
+                                &_crossbar_conflict_stalls[c]
+#endif
+    };
+    counts.assign(n, n + sizeof(n) / sizeof(n[0]));
+}
+
+void TrafficManager::_NewWarmupPeriod( sWarmupPeriod & p )
+{
+    p.stats.clear();
+    p.counts.clear();
+    for(int c = 0; c < _classes; ++c) {
+        vector<Stats *> stats;
+        vector<vector<int> *> counts;
+        _PeriodStats(c, stats, counts);
+        for(size_t i = 0; i < stats.size(); ++i) {
+            p.stats.push_back(new Stats(NULL, stats[i]->Name(), 
+                                        stats[i]->BinSize(), stats[i]->NumBins()));
+        }
+        for(size_t i = 0; i < counts.size(); ++i) {
+            p.counts.push_back(vector<int>(counts[i]->size(), 0));
+        }
+    }
+}
+
+// moves the statistics of the sample period that just ended into the record
+void TrafficManager::_RecordWarmupPeriod( )
+{
+    _warmup_record.push_back(sWarmupPeriod());
+    sWarmupPeriod & p = _warmup_record.back();
+    _NewWarmupPeriod(p);
+    p.start = _reset_time;
+    p.slowest_flit = _slowest_flit;
+    p.slowest_packet = _slowest_packet;
+    p.latency.resize(_classes);
+    p.accepted.resize(_classes);
+    int s = 0;
+    int n = 0;
+    for(int c = 0; c < _classes; ++c) {
+        vector<Stats *> stats;
+        vector<vector<int> *> counts;
+        _PeriodStats(c, stats, counts);
+        for(size_t i = 0; i < stats.size(); ++i) {
+            p.stats[s++]->Add(*stats[i]);
+        }
+        for(size_t i = 0; i < counts.size(); ++i) {
+            p.counts[n++] = *counts[i];
+        }
+
+        // a period in which nothing arrived counts as zero latency, which 
+        // only happens at the very start of the transient
+        p.latency[c] = (_plat_stats[c]->NumSamples() > 0) ? _plat_stats[c]->Average() : 0.0;
+        int accepted_count;
+        _ComputeStats(_accepted_flits[c], &accepted_count);
+        p.accepted[c] = (double)accepted_count / (double)(_time - _reset_time) / (double)_nodes;
+    }
+}
+
+// the first sample period of the steady state, or -1 if it is not yet 
+// known; every observed series has to have settled down
+int TrafficManager::_WarmupTruncation( ) const
 {
+    int start = 0;
     for(int c = 0; c < _classes; ++c) {
+        if(_measure_stats[c] == 0) {
+            continue;
+        }
+        vector<double> latency, accepted;
+        for(size_t i = 0; i < _warmup_record.size(); ++i) {
+            latency.push_back(_warmup_record[i].latency[c]);
+            accepted.push_back(_warmup_record[i].accepted[c]);
+        }
+        if(_measure_latency) {
+            int const d = MserTruncation(latency, _warmup_mser);
+            if(d < 0) {
+                return -1;
+            }
+            start = max(start, d * _warmup_mser);
+        }
+        int const d = MserTruncation(accepted, _warmup_mser);
+        if(d < 0) {
+            return -1;
+        }
+        start = max(start, d * _warmup_mser);
+    }
+    return start;
+}
 
-        map<int, Flit *>::const_iterator iter;
-        int i;
+// replaces the current statistics with those of the sample periods from 
+// start on, as if they had been cleared at the beginning of that period
+void TrafficManager::_TruncateWarmup( int start )
+{
+    _ClearStats( );
+    _reset_time = _warmup_record[start].start;
+    for(size_t i = start; i < _warmup_record.size(); ++i) {
+        sWarmupPeriod const & p = _warmup_record[i];
+        int s = 0;
+        int n = 0;
+        for(int c = 0; c < _classes; ++c) {
+            vector<Stats *> stats;
+            vector<vector<int> *> counts;
+            _PeriodStats(c, stats, counts);
+            Stats const * const plat = p.stats[s];
+            Stats const * const flat = p.stats[s + 2];
+
+            // the slowest flit and packet of the period with the longest latency
+            if((p.slowest_flit[c] >= 0) &&
+               ((_slowest_flit[c] < 0) || 
+                (_flat_stats[c]->Max() < flat->Max()))) {
+                _slowest_flit[c] = p.slowest_flit[c];
+            }
+            if((p.slowest_packet[c] >= 0) &&
+               ((_slowest_packet[c] < 0) || 
+                (_plat_stats[c]->Max() < plat->Max()))) {
+                _slowest_packet[c] = p.slowest_packet[c];
+            }
+
+            for(size_t j = 0; j < stats.size(); ++j) {
+                stats[j]->Add(*p.stats[s++]);
+            }
+            for(size_t j = 0; j < counts.size(); ++j) {
+                vector<int> const & count = p.counts[n++];
+                for(size_t k = 0; k < count.size(); ++k) {
+                    (*counts[j])[k] += count[k];
+                }
+            }
+
+            // the kept periods are the first batches of the stopping rule
+            if(_ci_stopping) {
+                if(plat->NumSamples() > 0) {
+                    _batch_plat[c].push_back(p.latency[c]);
+                }
+                _batch_accepted[c].push_back(p.accepted[c]);
+            }
+        }
+    }
+    for(int c = 0; c < _classes; ++c) {
+        int accepted_count;
+        _ComputeStats(_accepted_flits[c], &accepted_count);
+        _batch_plat_sum[c] = _plat_stats[c]->Sum();
+        _batch_plat_count[c] = _plat_stats[c]->NumSamples();
+        _batch_accepted_count[c] = accepted_count;
+    }
+    _ClearWarmupRecord( );
+}
+
+void TrafficManager::_ClearWarmupRecord( )
+{
+    for(size_t i = 0; i < _warmup_record.size(); ++i) {
+        for(size_t j = 0; j < _warmup_record[i].stats.size(); ++j) {
+            delete _warmup_record[i].stats[j];
+        }
+    }
+    _warmup_record.clear();
+}
+
+void TrafficManager::_DisplayRemaining( ostream & os ) const 
+{
+    for(int c = 0; c < _classes; ++c) {
 
         os << "Class " << c << ":" << endl;
 
+        // flit IDs are only tracked when built with TRACK_FLIT_IDS
         os << "Remaining flits: ";
-        for ( iter = _total_in_flight_flits[c].begin( ), i = 0;
-              ( iter != _total_in_flight_flits[c].end( ) ) && ( i < 10 );
-              iter++, i++ ) {
-            os << iter->first << " ";
-        }
-        if(_total_in_flight_flits[c].size() > 10)
-            os << "[...] ";
-    
-        os << "(" << _total_in_flight_flits[c].size() << " flits)" << endl;
+#ifdef TRACK_FLIT_IDS
+        _DisplayIds( _total_in_flight_ids[c], os );
+#endif
+        os << "(" << _total_in_flight_flits[c] << " flits)" << endl;
     
         os << "Measured flits: ";
-        for ( iter = _measured_in_flight_flits[c].begin( ), i = 0;
-              ( iter != _measured_in_flight_flits[c].end( ) ) && ( i < 10 );
-              iter++, i++ ) {
-            os << iter->first << " ";
-        }
-        if(_measured_in_flight_flits[c].size() > 10)
-            os << "[...] ";
-    
-        os << "(" << _measured_in_flight_flits[c].size() << " flits)" << endl;
+#ifdef TRACK_FLIT_IDS
+        _DisplayIds( _measured_in_flight_ids[c], os );
+#endif
+        os << "(" << _measured_in_flight_flits[c] << " flits)" << endl;
     
     }
 }
 
+#ifdef TRACK_FLIT_IDS
+void TrafficManager::_DisplayIds( IdSlab<bool> const & ids, ostream & os ) const
+{
+    int i = 0;
+    for ( int id = ids.Begin( ); ( id < ids.End( ) ) && ( i < 10 ); ++id ) {
+        if ( ids.Find( id ) ) {
+            os << id << " ";
+            ++i;
+        }
+    }
+    if(ids.Size() > 10)
+        os << "[...] ";
+}
+#endif
+
 bool TrafficManager::_SingleSim( )
 {
-    int converged = 0;
+    // a restored simulation continues with the saved progress
+    if ( _resuming ) {
+        _resuming = false;
+    } else {
+        _converged = 0;
   
-    //once warmed up, we require 3 converging runs to end the simulation 
-    vector<double> prev_latency(_classes, 0.0);
-    vector<double> prev_accepted(_classes, 0.0);
-    bool clear_last = false;
-    int total_phases = 0;
-    while( ( total_phases < _max_samples ) && 
+        //once warmed up, we require 3 converging runs to end the simulation 
+        _prev_latency.assign(_classes, 0.0);
+        _prev_accepted.assign(_classes, 0.0);
+        _prev_lag.assign(_classes, 0.0);
+        _saturated_periods.assign(_classes, 0);
+        _clear_last = false;
+        _total_phases = 0;
+        _warmup_phases = 0;
+        _ClearWarmupRecord( );
+    }
+
+    // the sample periods of an MSER warmup have a limit of their own
+    while( ( ( _total_phases - _warmup_phases ) < _max_samples ) && 
+           ( ( _sim_state != warming_up ) || ( _warmup_phases < _warmup_max_samples ) ) &&
            ( ( _sim_state != running ) || 
-             ( converged < 3 ) ) ) {
+             ( _converged < _converged_periods ) ) ) {
     
-        if ( clear_last || (( ( _sim_state == warming_up ) && ( ( total_phases % 2 ) == 0 ) )) ) {
-            clear_last = false;
+        // an MSER warmup records every sample period on its own
+        if ( _clear_last || (( ( _sim_state == warming_up ) && 
+                               ( ( _warmup_mser > 0 ) || ( ( _total_phases % 2 ) == 0 ) ) )) ) {
+            _clear_last = false;
             _ClearStats( );
         }
     
     
-        for ( int iter = 0; iter < _sample_period; ++iter )
-            _Step( );
+        for ( int iter = 0; iter < _sample_period; )
+            iter += _Advance( _sample_period - iter );
     
         //cout << _sim_state << endl;
 
@@ -1444,6 +2114,11 @@ bool TrafficManager::_SingleSim( )
         int lat_exc_class = -1;
         int lat_chg_exc_class = -1;
         int acc_chg_exc_class = -1;
+        int ci_exc_class = -1;
+        int sat_exc_class = -1;
+        double sat_lag_growth = 0.0;
+        double sat_accepted = 0.0;
+        double sat_offered = 0.0;
     
         for(int c = 0; c < _classes; ++c) {
       
@@ -1458,22 +2133,17 @@ bool TrafficManager::_SingleSim( )
             double total_accepted_rate = (double)total_accepted_count / (double)(_time - _reset_time);
             double cur_accepted = total_accepted_rate / (double)_nodes;
 
-            double latency_change = fabs((cur_latency - prev_latency[c]) / cur_latency);
-            prev_latency[c] = cur_latency;
+            double latency_change = fabs((cur_latency - _prev_latency[c]) / cur_latency);
+            _prev_latency[c] = cur_latency;
 
-            double accepted_change = fabs((cur_accepted - prev_accepted[c]) / cur_accepted);
-            prev_accepted[c] = cur_accepted;
+            double accepted_change = fabs((cur_accepted - _prev_accepted[c]) / cur_accepted);
+            _prev_accepted[c] = cur_accepted;
 
             double latency = (double)_plat_stats[c]->Sum();
             double count = (double)_plat_stats[c]->NumSamples();
       
-            map<int, Flit *>::const_iterator iter;
-            for(iter = _total_in_flight_flits[c].begin(); 
-                iter != _total_in_flight_flits[c].end(); 
-                iter++) {
-                latency += (double)(_time - iter->second->ctime);
-                count++;
-            }
+            latency += (double)((long long)_total_in_flight_flits[c] * _time - _total_in_flight_ctime[c]);
+            count += (double)_total_in_flight_flits[c];
       
             if((lat_exc_class < 0) &&
                (_latency_thres[c] >= 0.0) &&
@@ -1488,6 +2158,7 @@ bool TrafficManager::_SingleSim( )
                    (latency_change > _warmup_threshold[c])) {
                     lat_chg_exc_class = c;
                 } else if((_sim_state == running) &&
+                          (!_ci_stopping || (_stopping_ci[c] < 0.0)) &&
                           (_stopping_threshold[c] >= 0.0) &&
                           (latency_change > _stopping_threshold[c])) {
                     lat_chg_exc_class = c;
@@ -1501,19 +2172,104 @@ bool TrafficManager::_SingleSim( )
                    (accepted_change > _acc_warmup_threshold[c])) {
                     acc_chg_exc_class = c;
                 } else if((_sim_state == running) &&
+                          (!_ci_stopping || (_stopping_ci[c] < 0.0)) &&
                           (_acc_stopping_threshold[c] >= 0.0) &&
                           (accepted_change > _acc_stopping_threshold[c])) {
                     acc_chg_exc_class = c;
                 }
             }
+
+            if(_ci_stopping && (_sim_state == running)) {
+                double const plat_sum = _plat_stats[c]->Sum();
+                int const plat_count = _plat_stats[c]->NumSamples();
+                if(plat_count > _batch_plat_count[c]) {
+                    _batch_plat[c].push_back((plat_sum - _batch_plat_sum[c]) / 
+                                             (double)(plat_count - _batch_plat_count[c]));
+                }
+                _batch_plat_sum[c] = plat_sum;
+                _batch_plat_count[c] = plat_count;
+                _batch_accepted[c].push_back((double)(total_accepted_count - _batch_accepted_count[c]) / 
+                                             (double)(_time - _batch_time) / (double)_nodes);
+                _batch_accepted_count[c] = total_accepted_count;
+
+                double plat_mean, accepted_mean;
+                double const plat_ci = _BatchHalfWidth(_batch_plat[c], &plat_mean);
+                double const accepted_ci = _BatchHalfWidth(_batch_accepted[c], &accepted_mean);
+                cout << "latency confidence interval    = +/- " << plat_ci
+                     << " (" << _batch_plat[c].size() << " batches)" << endl;
+                cout << "throughput confidence interval = +/- " << accepted_ci
+                     << " (" << _batch_accepted[c].size() << " batches)" << endl;
+                if((ci_exc_class < 0) &&
+                   (_stopping_ci[c] >= 0.0) &&
+                   (((int)_batch_accepted[c].size() < _stopping_ci_batches) ||
+                    (accepted_ci > _stopping_ci[c] * accepted_mean) ||
+                    (_measure_latency &&
+                     (((int)_batch_plat[c].size() < _stopping_ci_batches) ||
+                      (plat_ci > _stopping_ci[c] * plat_mean))))) {
+                    ci_exc_class = c;
+                }
+            }
+
+            if(_saturation_periods > 0) {
+                // how far, on average, the sources are behind in
+                // generating packets; this stays bounded as long as the
+                // network keeps up with the offered load
+                double lag = 0.0;
+                for(int n = 0; n < _nodes; ++n) {
+                    if(_qtime[n][c] < _time) {
+                        lag += (double)(_time - _qtime[n][c]);
+                    }
+                }
+                lag /= (double)_nodes;
+                double const lag_growth = (lag - _prev_lag[c]) / (double)_sample_period;
+                _prev_lag[c] = lag;
+
+                // replies are generated on demand, so there is no nominal
+                // offered load to compare against in read/write mode
+                double const offered = _use_read_write[c] ? 0.0 : (_load[c] * _GetAveragePacketSize(c));
+
+                cout << "source queue lag  = " << lag << endl;
+                if((lag_growth > _saturation_thres) &&
+                   (_use_read_write[c] ||
+                    (cur_accepted < (1.0 - _saturation_thres) * offered))) {
+                    ++_saturated_periods[c];
+                    if((sat_exc_class < 0) &&
+                       (_saturated_periods[c] >= _saturation_periods)) {
+                        sat_exc_class = c;
+                        sat_lag_growth = lag_growth;
+                        sat_accepted = cur_accepted;
+                        sat_offered = offered;
+                    }
+                } else {
+                    _saturated_periods[c] = 0;
+                }
+            }
       
+        }
+        _batch_time = _time;
+
+        if ( _measure_latency && ( sat_exc_class >= 0 ) ) {
+
+            cout << "Source queues for class " << sat_exc_class << " fell behind in each of the last " << _saturation_periods << " sample periods (lag growing by " << sat_lag_growth << " cycles per cycle";
+            if(!_use_read_write[sat_exc_class]) {
+                cout << ", accepted " << sat_accepted << " of " << sat_offered << " flits/cycle/node offered";
+            }
+            cout << "). Aborting simulation." << endl;
+            _converged = 0; 
+            _sim_state = draining;
+            _drain_time = _time;
+            if(_stats_out) {
+                WriteStats(*_stats_out);
+            }
+            break;
+
         }
     
         // Fail safe for latency mode, throughput will ust continue
         if ( _measure_latency && ( lat_exc_class >= 0 ) ) {
       
             cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
-            converged = 0; 
+            _converged = 0; 
             _sim_state = draining;
             _drain_time = _time;
             if(_stats_out) {
@@ -1523,28 +2279,54 @@ bool TrafficManager::_SingleSim( )
       
         }
     
+        bool warmed_up = false;
         if ( _sim_state == warming_up ) {
-            if ( ( _warmup_periods > 0 ) ? 
-                 ( total_phases + 1 >= _warmup_periods ) :
-                 ( ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
-                   ( acc_chg_exc_class < 0 ) ) ) {
+            if ( _warmup_mser > 0 ) {
+                _RecordWarmupPeriod( );
+                ++_warmup_phases;
+                int const start = _WarmupTruncation( );
+                if ( start >= 0 ) {
+                    cout << "Warmed up ..." <<  "Time used is " << _time << " cycles" <<endl;
+                    cout << "Steady state since time " << _warmup_record[start].start
+                         << ", discarding " << start << " of " << _warmup_record.size()
+                         << " sample periods" << endl;
+                    _TruncateWarmup( start );
+                    warmed_up = true;
+                    _sim_state = running;
+                }
+            } else if ( ( _warmup_periods > 0 ) ? 
+                        ( _total_phases + 1 >= _warmup_periods ) :
+                        ( ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
+                          ( acc_chg_exc_class < 0 ) ) ) {
                 cout << "Warmed up ..." <<  "Time used is " << _time << " cycles" <<endl;
-                clear_last = true;
+                _clear_last = true;
+                warmed_up = true;
                 _sim_state = running;
             }
         } else if(_sim_state == running) {
-            if ( ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
+            if ( ( ci_exc_class < 0 ) &&
+                 ( !_measure_latency || ( lat_chg_exc_class < 0 ) ) &&
                  ( acc_chg_exc_class < 0 ) ) {
-                ++converged;
+                ++_converged;
             } else {
-                converged = 0;
+                _converged = 0;
+            }
+        }
+        ++_total_phases;
+
+        if ( !_checkpoint_out.empty( ) && !_checkpoint_saved &&
+             ( ( _checkpoint_at < 0 ) ? 
+               warmed_up :
+               ( _total_phases == _checkpoint_at ) ) ) {
+            _SaveCheckpoint( );
+            if ( _checkpoint_exit ) {
+                return true;
             }
         }
-        ++total_phases;
     }
   
     if ( _sim_state == running ) {
-        ++converged;
+        ++_converged;
     
         _sim_state  = draining;
         _drain_time = _time;
@@ -1553,9 +2335,7 @@ bool TrafficManager::_SingleSim( )
             cout << "Draining all recorded packets ..." << endl;
             int empty_steps = 0;
             while( _PacketsOutstanding( ) ) { 
-                _Step( ); 
-	
-                ++empty_steps;
+                empty_steps += _Advance( 1000 - empty_steps % 1000 ); 
 	
                 if ( empty_steps % 1000 == 0 ) {
 	  
@@ -1572,13 +2352,8 @@ bool TrafficManager::_SingleSim( )
                         double acc_latency = _plat_stats[c]->Sum();
                         double acc_count = (double)_plat_stats[c]->NumSamples();
 	    
-                        map<int, Flit *>::const_iterator iter;
-                        for(iter = _total_in_flight_flits[c].begin(); 
-                            iter != _total_in_flight_flits[c].end(); 
-                            iter++) {
-                            acc_latency += (double)(_time - iter->second->ctime);
-                            acc_count++;
-                        }
+                        acc_latency += (double)((long long)_total_in_flight_flits[c] * _time - _total_in_flight_ctime[c]);
+                        acc_count += (double)_total_in_flight_flits[c];
 	    
                         if((acc_latency / acc_count) > threshold) {
                             lat_exc_class = c;
@@ -1588,7 +2363,7 @@ bool TrafficManager::_SingleSim( )
 	  
                     if(lat_exc_class >= 0) {
                         cout << "Average latency for class " << lat_exc_class << " exceeded " << _latency_thres[lat_exc_class] << " cycles. Aborting simulation." << endl;
-                        converged = 0; 
+                        _converged = 0; 
                         _sim_state = warming_up;
                         if(_stats_out) {
                             WriteStats(*_stats_out);
@@ -1605,77 +2380,102 @@ bool TrafficManager::_SingleSim( )
         cout << "Too many sample periods needed to converge" << endl;
     }
   
-    return ( converged > 0 );
+    return ( _converged > 0 );
 }
 
-bool TrafficManager::Run( )
+// prepares the sources and statistics for a simulation on an empty network
+void TrafficManager::_ResetSim( )
 {
-    for ( int sim = 0; sim < _total_sims; ++sim ) {
+    _time = 0;
 
-        _time = 0;
-
-        //remove any pending request from the previous simulations
-        _requestsOutstanding.assign(_nodes, 0);
-        for (int i=0;i<_nodes;i++) {
-            while(!_repliesPending[i].empty()) {
-                _repliesPending[i].front()->Free();
-                _repliesPending[i].pop_front();
-            }
+    //remove any pending request from the previous simulations
+    _requestsOutstanding.assign(_nodes, 0);
+    for (int i=0;i<_nodes;i++) {
+        while(!_repliesPending[i].empty()) {
+            _repliesPending[i].front()->Free();
+            _repliesPending[i].pop_front();
         }
+    }
 
-        //reset queuetime for all sources
-        for ( int s = 0; s < _nodes; ++s ) {
-            _qtime[s].assign(_classes, 0);
-            _qdrained[s].assign(_classes, false);
-        }
+    //reset queuetime for all sources
+    for ( int s = 0; s < _nodes; ++s ) {
+        _qtime[s].assign(_classes, 0);
+        _qdrained[s].assign(_classes, false);
+    }
 
-        // warm-up ...
-        // reset stats, all packets after warmup_time marked
-        // converge
-        // draing, wait until all packets finish
-        _sim_state    = warming_up;
+    // warm-up ...
+    // reset stats, all packets after warmup_time marked
+    // converge
+    // draing, wait until all packets finish
+    _sim_state    = warming_up;
   
-        _ClearStats( );
+    _ClearStats( );
 
-        for(int c = 0; c < _classes; ++c) {
-            _traffic_pattern[c]->reset();
-            _injection_process[c]->reset();
-        }
+    for(int c = 0; c < _classes; ++c) {
+        _traffic_pattern[c]->reset();
+        _injection_process[c]->reset();
+    }
+    _ScheduleInjections( );
+}
 
-        if ( !_SingleSim( ) ) {
-            cout << "Simulation unstable, ending ..." << endl;
-            return false;
-        }
+// stops generating packets and runs until the network is empty
+void TrafficManager::_DrainNetwork( )
+{
+    // Empty any remaining packets
+    cout << "Draining remaining packets ..." << endl;
+    _empty_network = true;
+    int empty_steps = 0;
 
-        // Empty any remaining packets
-        cout << "Draining remaining packets ..." << endl;
-        _empty_network = true;
-        int empty_steps = 0;
+    bool packets_left = false;
+    for(int c = 0; c < _classes; ++c) {
+        packets_left |= (_total_in_flight_flits[c] > 0);
+    }
+
+    while( packets_left ) { 
+        empty_steps += _Advance( 1000 - empty_steps % 1000 ); 
 
-        bool packets_left = false;
+        if ( empty_steps % 1000 == 0 ) {
+            _DisplayRemaining( ); 
+        }
+      
+        packets_left = false;
         for(int c = 0; c < _classes; ++c) {
-            packets_left |= !_total_in_flight_flits[c].empty();
+            packets_left |= (_total_in_flight_flits[c] > 0);
         }
+    }
+    //wait until all the credits are drained as well
+    while(Credit::OutStanding()!=0){
+        _Advance(numeric_limits<int>::max());
+    }
+    _empty_network = false;
+}
 
-        while( packets_left ) { 
-            _Step( ); 
+bool TrafficManager::Run( )
+{
+    _sim = 0;
+    if ( !_checkpoint_in.empty( ) ) {
+        _RestoreCheckpoint( );
+    }
 
-            ++empty_steps;
+    for ( ; _sim < _total_sims; ++_sim ) {
 
-            if ( empty_steps % 1000 == 0 ) {
-                _DisplayRemaining( ); 
-            }
-      
-            packets_left = false;
-            for(int c = 0; c < _classes; ++c) {
-                packets_left |= !_total_in_flight_flits[c].empty();
-            }
+        if ( !_resuming ) {
+            _ResetSim( );
+        }
+
+        bool const stable = _SingleSim( );
+
+        if ( _checkpoint_saved && _checkpoint_exit ) {
+            cout << "Checkpoint saved, ending ..." << endl;
+            return true;
         }
-        //wait until all the credits are drained as well
-        while(Credit::OutStanding()!=0){
-            _Step();
+
+        if ( !stable ) {
+            cout << "Simulation unstable, ending ..." << endl;
+            return false;
         }
-        _empty_network = false;
+
+        _DrainNetwork( );
 
         //for the love of god don't ever say "Time taken" anywhere else
         //the power script depend on it
@@ -1695,6 +2495,252 @@ bool TrafficManager::Run( )
     return true;
 }
 
+// the statistics and the injection buffer states are saved as children
+void TrafficManager::_Serialize( Checkpoint & cp )
+{
+    cp.Check( "nodes", _nodes );
+    cp.Check( "classes", _classes );
+    cp.Check( "subnets", _subnets );
+    cp.Check( "num_vcs", _vcs );
+
+    cp.Value( _sim );
+    cp.Value( _total_phases );
+    cp.Value( _warmup_phases );
+    cp.Value( _converged );
+    cp.Value( _clear_last );
+    cp.Value( _prev_latency );
+    cp.Value( _prev_accepted );
+    cp.Value( _prev_lag );
+    cp.Value( _saturated_periods );
+    cp.Value( _batch_plat );
+    cp.Value( _batch_accepted );
+    cp.Value( _batch_plat_sum );
+    cp.Value( _batch_plat_count );
+    cp.Value( _batch_accepted_count );
+    cp.Value( _batch_time );
+
+    int const periods = cp.Size( _warmup_record.size( ) );
+    if ( cp.Restoring( ) ) {
+        _ClearWarmupRecord( );
+        _warmup_record.resize( periods );
+        for ( int i = 0; i < periods; ++i ) {
+            _NewWarmupPeriod( _warmup_record[i] );
+        }
+    }
+    for ( int i = 0; i < periods; ++i ) {
+        sWarmupPeriod & p = _warmup_record[i];
+        cp.Value( p.start );
+        for ( size_t j = 0; j < p.stats.size( ); ++j ) {
+            p.stats[j]->Serialize( cp );
+        }
+        cp.Value( p.counts );
+        cp.Value( p.slowest_flit );
+        cp.Value( p.slowest_packet );
+        cp.Value( p.latency );
+        cp.Value( p.accepted );
+    }
+
+    cp.Value( _sim_state );
+    cp.Value( _reset_time );
+    cp.Value( _drain_time );
+    cp.Value( _time );
+    cp.Value( _cur_id );
+    cp.Value( _cur_pid );
+    cp.Value( _deadlock_timer );
+    cp.Value( _empty_network );
+
+    cp.Value( _last_class );
+    cp.Value( _last_vc );
+    cp.Value( _qtime );
+    cp.Value( _qdrained );
+    for ( int s = 0; s < _nodes; ++s ) {
+        for ( int c = 0; c < _classes; ++c ) {
+            list<sQueuedPacket> & pp = _partial_packets[s][c];
+            pp.resize( cp.Size( pp.size( ) ) );
+            for ( list<sQueuedPacket>::iterator iter = pp.begin( );
+                  iter != pp.end( ); ++iter ) {
+                cp.Value( iter->pid );
+                cp.Value( iter->id );
+                cp.Value( iter->size );
+                cp.Value( iter->next );
+                cp.Value( iter->flit );
+                cp.Value( iter->ctime );
+                cp.Value( iter->dest );
+                cp.Value( iter->subnetwork );
+                cp.Value( iter->pri );
+                cp.Value( iter->type );
+                cp.Value( iter->record );
+                cp.Value( iter->watch );
+            }
+        }
+    }
+    cp.Value( _injection_calendar );
+    cp.Value( _injection_due );
+    for ( int c = 0; c < _classes; ++c ) {
+        _injection_process[c]->Serialize( cp );
+    }
+
+    cp.Value( _total_in_flight_flits );
+    cp.Value( _measured_in_flight_flits );
+    cp.Value( _total_in_flight_ctime );
+#ifdef TRACK_FLIT_IDS
+    cp.Value( _total_in_flight_ids );
+    cp.Value( _measured_in_flight_ids );
+#endif
+    cp.Value( _retired_packets );
+    cp.Value( _ejected_flits );
+
+    cp.Value( _packet_seq_no );
+    cp.Value( _repliesPending );
+    cp.Value( _requestsOutstanding );
+
+#ifdef TRACK_FLOWS
+    cp.Value( _outstanding_credits );
+    cp.Value( _outstanding_classes );
+    cp.Value( _injected_flits );
+#endif
+
+    cp.Value( _sent_packets );
+    cp.Value( _accepted_packets );
+    cp.Value( _sent_flits );
+    cp.Value( _accepted_flits );
+#ifdef TRACK_STALLS
+    cp.Value( _buffer_busy_stalls );
+    cp.Value( _buffer_conflict_stalls );
+    cp.Value( _buffer_full_stalls );
+    cp.Value( _buffer_reserved_stalls );
+    cp.Value( _crossbar_conflict_stalls );
+#endif
+    cp.Value( _slowest_packet );
+    cp.Value( _slowest_flit );
+
+    cp.Value( _overall_min_plat );
+    cp.Value( _overall_avg_plat );
+    cp.Value( _overall_max_plat );
+    cp.Value( _overall_min_nlat );
+    cp.Value( _overall_avg_nlat );
+    cp.Value( _overall_max_nlat );
+    cp.Value( _overall_min_flat );
+    cp.Value( _overall_avg_flat );
+    cp.Value( _overall_max_flat );
+    cp.Value( _overall_min_frag );
+    cp.Value( _overall_avg_frag );
+    cp.Value( _overall_max_frag );
+    cp.Value( _overall_hop_stats );
+    cp.Value( _overall_plat_ci );
+    cp.Value( _overall_accepted_ci );
+    cp.Value( _overall_min_sent_packets );
+    cp.Value( _overall_avg_sent_packets );
+    cp.Value( _overall_max_sent_packets );
+    cp.Value( _overall_min_accepted_packets );
+    cp.Value( _overall_avg_accepted_packets );
+    cp.Value( _overall_max_accepted_packets );
+    cp.Value( _overall_min_sent );
+    cp.Value( _overall_avg_sent );
+    cp.Value( _overall_max_sent );
+    cp.Value( _overall_min_accepted );
+    cp.Value( _overall_avg_accepted );
+    cp.Value( _overall_max_accepted );
+#ifdef TRACK_STALLS
+    cp.Value( _overall_buffer_busy_stalls );
+    cp.Value( _overall_buffer_conflict_stalls );
+    cp.Value( _overall_buffer_full_stalls );
+    cp.Value( _overall_buffer_reserved_stalls );
+    cp.Value( _overall_crossbar_conflict_stalls );
+#endif
+}
+
+// saves the random number generator, the traffic manager and the networks
+// at the end of a sample period
+void TrafficManager::_SaveCheckpoint( )
+{
+    {
+        Checkpoint cp( _checkpoint_out, false );
+        vector<long> state_x;
+        vector<double> state_u;
+        SaveFullRandomState( state_x, state_u );
+        cp.Value( state_x );
+        cp.Value( state_u );
+        Serialize( cp );
+        for ( int i = 0; i < _subnets; ++i ) {
+            _net[i]->Serialize( cp );
+        }
+        cp.Section( "end" );
+    }
+    _checkpoint_saved = true;
+    cout << "Saved checkpoint " << _checkpoint_out << " after sample period "
+         << _total_phases << " of simulation " << _sim << " at time " << _time
+         << "." << endl;
+}
+
+// replaces the state of the newly built simulation with the saved one; the
+// next simulation run continues the saved one with the following sample 
+// period
+void TrafficManager::_RestoreCheckpoint( )
+{
+    {
+        Checkpoint cp( _checkpoint_in, true );
+        vector<long> state_x;
+        vector<double> state_u;
+        cp.Value( state_x );
+        cp.Value( state_u );
+        RestoreFullRandomState( state_x, state_u );
+        Serialize( cp );
+        for ( int i = 0; i < _subnets; ++i ) {
+            _net[i]->Serialize( cp );
+        }
+        cp.Section( "end" );
+    }
+    if ( _checkpoint_reseed ) {
+        RandomSeed( _seed );
+        for ( int i = 0; i < _subnets; ++i ) {
+            _net[i]->SeedRandom( RandomStreamSeed( i ) );
+        }
+    }
+    _resuming = true;
+    cout << "Restored checkpoint " << _checkpoint_in << " after sample period "
+         << _total_phases << " of simulation " << _sim << " at time " << _time
+         << "." << endl;
+}
+
+void TrafficManager::_ClearOverallStats( )
+{
+    _overall_min_plat.assign(_classes, 0.0);
+    _overall_avg_plat.assign(_classes, 0.0);
+    _overall_max_plat.assign(_classes, 0.0);
+    _overall_min_nlat.assign(_classes, 0.0);
+    _overall_avg_nlat.assign(_classes, 0.0);
+    _overall_max_nlat.assign(_classes, 0.0);
+    _overall_min_flat.assign(_classes, 0.0);
+    _overall_avg_flat.assign(_classes, 0.0);
+    _overall_max_flat.assign(_classes, 0.0);
+    _overall_min_frag.assign(_classes, 0.0);
+    _overall_avg_frag.assign(_classes, 0.0);
+    _overall_max_frag.assign(_classes, 0.0);
+    _overall_hop_stats.assign(_classes, 0.0);
+    _overall_plat_ci.assign(_classes, 0.0);
+    _overall_accepted_ci.assign(_classes, 0.0);
+    _overall_min_sent_packets.assign(_classes, 0.0);
+    _overall_avg_sent_packets.assign(_classes, 0.0);
+    _overall_max_sent_packets.assign(_classes, 0.0);
+    _overall_min_accepted_packets.assign(_classes, 0.0);
+    _overall_avg_accepted_packets.assign(_classes, 0.0);
+    _overall_max_accepted_packets.assign(_classes, 0.0);
+    _overall_min_sent.assign(_classes, 0.0);
+    _overall_avg_sent.assign(_classes, 0.0);
+    _overall_max_sent.assign(_classes, 0.0);
+    _overall_min_accepted.assign(_classes, 0.0);
+    _overall_avg_accepted.assign(_classes, 0.0);
+    _overall_max_accepted.assign(_classes, 0.0);
+#ifdef TRACK_STALLS
+    _overall_buffer_busy_stalls.assign(_classes, 0);
+    _overall_buffer_conflict_stalls.assign(_classes, 0);
+    _overall_buffer_full_stalls.assign(_classes, 0);
+    _overall_buffer_reserved_stalls.assign(_classes, 0);
+    _overall_crossbar_conflict_stalls.assign(_classes, 0);
+#endif
+}
+
 void TrafficManager::_UpdateOverallStats() {
     for ( int c = 0; c < _classes; ++c ) {
     
@@ -1718,6 +2764,11 @@ void TrafficManager::_UpdateOverallStats() {
 
         _overall_hop_stats[c] += _hop_stats[c]->Average();
 
+        if(_ci_stopping) {
+            _overall_plat_ci[c] += _BatchHalfWidth(_batch_plat[c]);
+            _overall_accepted_ci[c] += _BatchHalfWidth(_batch_accepted[c]);
+        }
+
         int count_min, count_sum, count_max;
         double rate_min, rate_sum, rate_max;
         double rate_avg;
@@ -2050,8 +3101,8 @@ void TrafficManager::DisplayStats(ostream & os) const {
         cout << "Injected packet length average = " << (double)sent_flits / (double)sent_packets << endl
              << "Accepted packet length average = " << (double)accepted_flits / (double)accepted_packets << endl;
 
-        cout << "Total in-flight flits = " << _total_in_flight_flits[c].size()
-             << " (" << _measured_in_flight_flits[c].size() << " measured)"
+        cout << "Total in-flight flits = " << _total_in_flight_flits[c]
+             << " (" << _measured_in_flight_flits[c] << " measured)"
              << endl;
     
 #ifdef TRACK_STALLS
@@ -2097,6 +3148,11 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_plat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        if(_ci_stopping) {
+            os << "\t" << 100.0 * _stopping_ci_level << "% confidence interval = +/- "
+               << _overall_plat_ci[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+        }
 
         os << "Network latency average = " << _overall_avg_nlat[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
@@ -2146,6 +3202,11 @@ void TrafficManager::DisplayOverallStats( ostream & os ) const {
            << " (" << _total_sims << " samples)" << endl;
         os << "\tmaximum = " << _overall_max_accepted[c] / (double)_total_sims
            << " (" << _total_sims << " samples)" << endl;
+        if(_ci_stopping) {
+            os << "\t" << 100.0 * _stopping_ci_level << "% confidence interval = +/- "
+               << _overall_accepted_ci[c] / (double)_total_sims
+               << " (" << _total_sims << " samples)" << endl;
+        }
     
         os << "Injected packet size average = " << _overall_avg_sent[c] / _overall_avg_sent_packets[c]
            << " (" << _total_sims << " samples)" << endl;
@@ -31,6 +31,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <queue>
 #include <cassert>
 
 #include "module.hpp"
@@ -43,6 +44,8 @@
 #include "routefunc.hpp"
 #include "outputset.hpp"
 #include "injection.hpp"
+#include "id_slab.hpp"
+#include "thread_pool.hpp"
 
 //register the requests to a node
 class PacketReplyInfo;
@@ -86,6 +89,15 @@ protected:
   vector<TrafficPattern *> _traffic_pattern;
   vector<InjectionProcess *> _injection_process;
 
+  // skip-ahead injection: for these classes, _qtime holds the next cycle in
+  // which each source injects, rather than the next cycle to be tested;
+  // sources whose cycle has come are kept in _injection_due, the others in
+  // a calendar ordered by that cycle
+  vector<bool> _skip_ahead;
+  vector<priority_queue<pair<int, int>, vector<pair<int, int> >, 
+			greater<pair<int, int> > > > _injection_calendar;
+  vector<list<int> > _injection_due;
+
   // ============ Message priorities ============ 
 
   enum ePriority { class_based, age_based, network_age_based, local_age_based, queue_length_based, hop_count_based, sequence_based, none };
@@ -111,13 +123,40 @@ protected:
 
   vector<vector<int> > _qtime;
   vector<vector<bool> > _qdrained;
-  vector<vector<list<Flit *> > > _partial_packets;
-
-  vector<map<int, Flit *> > _total_in_flight_flits;
-  vector<map<int, Flit *> > _measured_in_flight_flits;
-  vector<map<int, Flit *> > _retired_packets;
+  // packets in the source queues; their flits are only allocated one at a
+  // time, as each becomes the next flit to be injected
+  struct sQueuedPacket {
+    int pid;
+    int id;             // ID of the head flit; the rest follow consecutively
+    int size;
+    int next;           // index of the next flit to be allocated
+    Flit * flit;        // next flit to be injected
+    int ctime;
+    int dest;
+    int subnetwork;
+    int pri;
+    Flit::FlitType type;
+    bool record;
+    bool watch;
+  };
+  vector<vector<list<sQueuedPacket> > > _partial_packets;
+
+  // flits generated but not yet retired; the sum of their creation times
+  // gives their aggregate latency so far without visiting each flit
+  vector<int> _total_in_flight_flits;
+  vector<int> _measured_in_flight_flits;
+  vector<long long> _total_in_flight_ctime;
+#ifdef TRACK_FLIT_IDS
+  vector<IdSlab<bool> > _total_in_flight_ids;
+  vector<IdSlab<bool> > _measured_in_flight_ids;
+#endif
+  // head flits of packets whose tail has not arrived yet, by packet ID
+  vector<IdSlab<Flit *> > _retired_packets;
   bool _empty_network;
 
+  // skip over cycles in which nothing but the clock can change
+  bool _fast_forward;
+
   bool _hold_switch_for_packet;
 
   // ============ physical sub-networks ==========
@@ -126,6 +165,13 @@ protected:
 
   vector<int> _subnet;
 
+  // steps each subnet's network on its own thread (parallel_subnets)
+  ThreadPool * _subnet_pool;
+  class SubnetTask;
+
+  // flits ejected in the current cycle, by subnet and node
+  vector<vector<Flit *> > _ejected_flits;
+
   // ============ deadlock ==========
 
   int _deadlock_timer;
@@ -166,6 +212,11 @@ protected:
   vector<Stats *> _hop_stats;
   vector<double> _overall_hop_stats;
 
+  // half-widths of the confidence intervals reached by the batch-means 
+  // stopping rule
+  vector<double> _overall_plat_ci;
+  vector<double> _overall_accepted_ci;
+
   vector<vector<int> > _sent_packets;
   vector<double> _overall_min_sent_packets;
   vector<double> _overall_avg_sent_packets;
@@ -223,12 +274,66 @@ protected:
 
   vector<double> _latency_thres;
 
+  // give up once the source queues have kept falling behind for this many
+  // sample periods
+  int _saturation_periods;
+  double _saturation_thres;
+
   vector<double> _stopping_threshold;
   vector<double> _acc_stopping_threshold;
 
+  // batch-means stopping rule: every sample period is a batch, and the 
+  // simulation ends once the confidence intervals of the mean latency and 
+  // accepted rate are narrower than _stopping_ci times the mean; classes 
+  // without a target keep the change thresholds over _converged_periods
+  bool _ci_stopping;
+  int _converged_periods;
+  vector<double> _stopping_ci;
+  double _stopping_ci_level;
+  int _stopping_ci_batches;
+
   vector<double> _warmup_threshold;
   vector<double> _acc_warmup_threshold;
 
+  // MSER warmup: the statistics of every warmup sample period are kept 
+  // until the end of the transient has been found, and those of the periods
+  // after it then count towards the measurement; _warmup_mser is the 
+  // number of sample periods averaged into each MSER batch, and the warm up
+  // fails after _warmup_max_samples periods
+  int _warmup_mser;
+  int _warmup_max_samples;
+  struct sWarmupPeriod {
+    int start;
+    vector<Stats *> stats;         // see _PeriodStats, for each class
+    vector<vector<int> > counts;
+    vector<int> slowest_flit;
+    vector<int> slowest_packet;
+    vector<double> latency;        // the observations MSER is applied to
+    vector<double> accepted;
+  };
+  vector<sWarmupPeriod> _warmup_record;
+
+  // progress of the current simulation's sample periods, kept between 
+  // calls so that a restored simulation picks up where it was saved
+  int _sim;
+  int _total_phases;
+  int _warmup_phases;
+  int _converged;
+  bool _clear_last;
+  vector<double> _prev_latency;
+  vector<double> _prev_accepted;
+  vector<double> _prev_lag;
+  vector<int> _saturated_periods;
+
+  // batch means since the statistics were last cleared, and the totals at
+  // the end of the previous batch
+  vector<vector<double> > _batch_plat;
+  vector<vector<double> > _batch_accepted;
+  vector<double> _batch_plat_sum;
+  vector<int> _batch_plat_count;
+  vector<int> _batch_accepted_count;
+  int _batch_time;
+
   int _cur_id;
   int _cur_pid;
   int _time;
@@ -238,6 +343,21 @@ protected:
 
   bool _print_csv_results;
 
+  // ============ Checkpoints ============
+
+  // the state is saved once, after _checkpoint_at sample periods of a 
+  // simulation or, if that is negative, once it has warmed up
+  string _checkpoint_out;
+  int _checkpoint_at;
+  bool _checkpoint_exit;
+  bool _checkpoint_saved;
+
+  string _checkpoint_in;
+  bool _checkpoint_reseed;
+  long _seed;
+  // set while the restored simulation has not resumed yet
+  bool _resuming;
+
   //flits to watch
   ostream * _stats_out;
 
@@ -264,26 +384,57 @@ protected:
 
   virtual void _RetireFlit( Flit *f, int dest );
 
-  void _Inject();
+  bool _Inject();
   void _Step( );
+  void _CheckDeadlock( );
+  void _SimulateCycle( bool inject = true );
+  int  _Advance( int max_cycles );
+
+  void _ReadSubnet( int subnet );
+  void _EvaluateSubnet( int subnet );
+  void _RunSubnets( void (TrafficManager::*phase)( int ) );
 
   bool _PacketsOutstanding( ) const;
   
   virtual int  _IssuePacket( int source, int cl );
   void _GeneratePacket( int source, int size, int cl, int time );
+  int _NextInjection( int source, int cl, int time );
+  void _ScheduleInjections( );
+  void _InjectSkipAhead( int cl );
+  Flit * _NewFlit( sQueuedPacket & p, int source, int cl );
 
   virtual void _ClearStats( );
 
   void _ComputeStats( const vector<int> & stats, int *sum, int *min = NULL, int *max = NULL, int *min_pos = NULL, int *max_pos = NULL ) const;
 
+  double _BatchHalfWidth( const vector<double> & batches, double *mean = NULL ) const;
+
+  void _PeriodStats( int c, vector<Stats *> & stats, vector<vector<int> *> & counts );
+  void _NewWarmupPeriod( sWarmupPeriod & p );
+  void _RecordWarmupPeriod( );
+  int _WarmupTruncation( ) const;
+  void _TruncateWarmup( int start );
+  void _ClearWarmupRecord( );
+
   virtual bool _SingleSim( );
 
+  void _ResetSim( );
+  void _DrainNetwork( );
+
   void _DisplayRemaining( ostream & os = cout ) const;
+#ifdef TRACK_FLIT_IDS
+  void _DisplayIds( IdSlab<bool> const & ids, ostream & os ) const;
+#endif
   
   void _LoadWatchList(const string & filename);
 
+  void _ClearOverallStats( );
   virtual void _UpdateOverallStats();
 
+  virtual void _Serialize( Checkpoint & cp );
+  void _SaveCheckpoint( );
+  void _RestoreCheckpoint( );
+
   virtual string _OverallStatsCSV(int c = 0) const;
 
   int _GetNextPacketSize(int cl) const;
@@ -297,7 +448,7 @@ public:
   TrafficManager( const Configuration &config, const vector<Network *> & net );
   virtual ~TrafficManager( );
 
-  bool Run( );
+  virtual bool Run( );
 
   virtual void WriteStats( ostream & os = cout ) const ;
   virtual void UpdateStats( ) ;
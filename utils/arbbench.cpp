@@ -0,0 +1,169 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this 
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*arbbench.cpp
+ *
+ *Microbenchmark that compares the arbiter implementations selected by the
+ *arb_type parameter. For each radix, every arbiter is fed the same random
+ *request sequence, once with all requests at the same priority and once 
+ *with mixed priorities; the average time per arbitration is reported along
+ *with a checksum of the grants, which must agree between the scan-based 
+ *and bitmask-based variants of the same arbitration scheme. The arbiters
+ *take turns over several repetitions and the fastest time of each is 
+ *reported, which keeps the comparison stable on a loaded machine.
+ *
+ *Build it from the src directory after compiling the simulator:
+ *
+ *  g++ -O3 -I. -Iarbiters ../utils/arbbench.cpp arbiters/[a-z]*.o module.o \
+ *    checkpoint.o flit.o credit.o packet_reply_info.o outputset.o \
+ *    misc_utils.o -pthread -o arbbench
+ *
+ *Usage: ./arbbench [cycles] [radix ...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <ctime>
+
+#include "arbiter.hpp"
+
+using namespace std;
+
+struct request_t {
+  int input;
+  int pri;
+};
+
+static void generate( int radix, int cycles, bool mixed_pri,
+		      vector<vector<request_t> > & trace )
+{
+  trace.resize(cycles);
+  for ( int c = 0; c < cycles; ++c ) {
+    trace[c].clear();
+    for ( int i = 0; i < radix; ++i ) {
+      if ( rand() % 2 ) {
+	request_t r;
+	r.input = i;
+	r.pri = mixed_pri ? rand() % 4 : 0;
+	trace[c].push_back(r);
+      }
+    }
+  }
+}
+
+static double run( const string & arb_type, int radix,
+		   const vector<vector<request_t> > & trace,
+		   unsigned long long & checksum )
+{
+  Arbiter * arb = Arbiter::NewArbiter(NULL, "arb", arb_type, radix);
+  checksum = 0;
+  clock_t start = clock();
+  for ( size_t c = 0; c < trace.size(); ++c ) {
+    const vector<request_t> & reqs = trace[c];
+    for ( size_t r = 0; r < reqs.size(); ++r ) {
+      arb->AddRequest(reqs[r].input, reqs[r].input, reqs[r].pri);
+    }
+    int id = -1;
+    int winner = arb->Arbitrate(&id, NULL);
+    if ( winner >= 0 ) {
+      arb->UpdateState();
+    }
+    checksum = checksum * 31 + (unsigned long long)( winner + 1 );
+    arb->Clear();
+  }
+  clock_t stop = clock();
+  delete arb;
+  return 1.0e9 * (double)( stop - start ) / CLOCKS_PER_SEC / trace.size();
+}
+
+int main( int argc, char **argv )
+{
+  int cycles = ( argc > 1 ) ? atoi(argv[1]) : 200000;
+  int const reps = 5;
+
+  vector<int> radices;
+  for ( int i = 2; i < argc; ++i ) {
+    radices.push_back(atoi(argv[i]));
+  }
+  if ( radices.empty() ) {
+    int const defaults[] = { 5, 8, 16, 32, 48, 64 };
+    radices.assign(defaults, defaults + sizeof(defaults) / sizeof(int));
+  }
+
+  // pairs of scan-based and bitmask-based arbiters
+  string const types[] = { "matrix", "bitmask_matrix" };
+  int const num_types = sizeof(types) / sizeof(string);
+
+  cout << setw(6) << "radix" << setw(8) << "pri" << setw(22) << "arb_type"
+       << setw(12) << "ns/arb" << setw(10) << "speedup" << endl;
+
+  bool ok = true;
+  for ( size_t r = 0; r < radices.size(); ++r ) {
+    int const radix = radices[r];
+    for ( int mixed = 0; mixed < 2; ++mixed ) {
+      vector<vector<request_t> > trace;
+      srand(radix);
+      generate(radix, cycles, mixed, trace);
+      vector<double> times(num_types, 0.0);
+      vector<unsigned long long> sums(num_types, 0);
+      for ( int rep = 0; rep < reps; ++rep ) {
+	for ( int t = 0; t < num_types; ++t ) {
+	  double const time = run(types[t], radix, trace, sums[t]);
+	  if ( ( rep == 0 ) || ( time < times[t] ) ) {
+	    times[t] = time;
+	  }
+	}
+      }
+      double ref_time = 0.0;
+      unsigned long long ref_sum = 0;
+      for ( int t = 0; t < num_types; ++t ) {
+	double const time = times[t];
+	unsigned long long const sum = sums[t];
+	bool const bitmask = ( t % 2 == 1 );
+	cout << setw(6) << radix << setw(8) << ( mixed ? "mixed" : "same" )
+	     << setw(22) << types[t] << setw(12) << fixed << setprecision(1)
+	     << time;
+	if ( bitmask ) {
+	  cout << setw(9) << setprecision(2) << ref_time / time << "x";
+	  if ( sum != ref_sum ) {
+	    cout << "  grants differ from " << types[t - 1];
+	    ok = false;
+	  }
+	} else {
+	  ref_time = time;
+	  ref_sum = sum;
+	}
+	cout << endl;
+      }
+    }
+  }
+
+  return ok ? 0 : 1;
+}
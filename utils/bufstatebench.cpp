@@ -0,0 +1,186 @@
+// $Id$
+
+/*
+ Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions are met:
+
+ Redistributions of source code must retain the above copyright notice, this
+ list of conditions and the following disclaimer.
+ Redistributions in binary form must reproduce the above copyright notice, this
+ list of conditions and the following disclaimer in the documentation and/or
+ other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*bufstatebench.cpp
+ *
+ *Microbenchmark of the output VC allocation loop: each cycle, every port
+ *checks all of its VCs for being available and not full (the
+ *BufferState::IsAvailableFor and IsFullFor calls made by the VC allocators
+ *and by the traffic manager at every injection port), takes the first
+ *candidate after the previously used VC and sends a single-flit packet on
+ *it; the matching credit comes back a fixed number of cycles later. The
+ *average time per port and cycle is reported for each buffer policy, along
+ *with a checksum of the candidates found, which must not change between
+ *builds.
+ *
+ *To compare two revisions, build it from the src directory after
+ *compiling the simulator at each revision:
+ *
+ *  g++ -O3 -I. ../utils/bufstatebench.cpp buffer_state.o module.o \
+ *    checkpoint.o flit.o credit.o packet_reply_info.o outputset.o \
+ *    booksim_config.o config_utils.o y.tab.o lex.yy.o -pthread \
+ *    -o bufstatebench
+ *
+ *Usage: ./bufstatebench [cycles] [num_vcs] [policy ...]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <ctime>
+
+#include "booksim.hpp"
+#include "booksim_config.hpp"
+#include "buffer_state.hpp"
+#include "globals.hpp"
+
+using namespace std;
+
+// the pieces of the simulator's globals that the linked objects refer to
+static int _time = 0;
+int GetSimTime( ) { return _time; }
+thread_local ostream * gWatchOut = NULL;
+thread_local bool gTrace = false;
+thread_local bool gPrintActivity = false;
+thread_local int gK = 0;
+thread_local int gN = 0;
+thread_local int gC = 0;
+thread_local int gNodes = 0;
+
+static int const PORTS = 64;
+// with two slots per VC, credits take long enough to come back that the 
+// buffers fill up and the scan has to skip full VCs
+static int const VC_BUF_SIZE = 2;
+static int const CREDIT_DELAY = 24;
+
+static double run( const string & policy, int vcs, int cycles,
+		   unsigned long long & checksum )
+{
+  BookSimConfig config;
+  config.Assign("buffer_policy", policy);
+  config.Assign("num_vcs", vcs);
+  config.Assign("vc_buf_size", VC_BUF_SIZE);
+
+  vector<BufferState *> bufs(PORTS);
+  for ( int p = 0; p < PORTS; ++p ) {
+    bufs[p] = new BufferState(config, NULL, "buf");
+    bufs[p]->SetMinLatency(2 * CREDIT_DELAY);
+  }
+  vector<int> last_vc(PORTS, 0);
+
+  // credits in flight, by return cycle and port
+  vector<vector<Credit *> > credits(CREDIT_DELAY,
+				    vector<Credit *>(PORTS, (Credit *)NULL));
+
+  Flit * f = Flit::New();
+  f->head = true;
+  f->tail = true;
+
+  checksum = 0;
+  clock_t start = clock();
+  for ( _time = 0; _time < cycles; ++_time ) {
+    vector<Credit *> & due = credits[_time % CREDIT_DELAY];
+    for ( int p = 0; p < PORTS; ++p ) {
+      BufferState * const buf = bufs[p];
+      if ( due[p] ) {
+	buf->ProcessCredit(due[p]);
+	due[p]->Free();
+	due[p] = NULL;
+      }
+      // like the VC allocator, look at every VC before picking one
+      int selected = -1;
+      int candidates = 0;
+      for ( int i = 1; i <= vcs; ++i ) {
+	int const vc = ( last_vc[p] + i ) % vcs;
+	if ( buf->IsAvailableFor(vc) && !buf->IsFullFor(vc) ) {
+	  if ( selected < 0 ) {
+	    selected = vc;
+	  }
+	  ++candidates;
+	}
+      }
+      checksum = checksum * 31 + (unsigned long long)( selected + 1 );
+      checksum = checksum * 31 + (unsigned long long)candidates;
+      if ( selected >= 0 ) {
+	last_vc[p] = selected;
+	f->vc = selected;
+	buf->TakeBuffer(selected);
+	buf->SendingFlit(f);
+	Credit * const c = Credit::New();
+	c->AddVC(selected);
+	due[p] = c;
+      }
+    }
+  }
+  clock_t stop = clock();
+
+  for ( int d = 0; d < CREDIT_DELAY; ++d ) {
+    for ( int p = 0; p < PORTS; ++p ) {
+      if ( credits[d][p] ) {
+	credits[d][p]->Free();
+      }
+    }
+  }
+  for ( int p = 0; p < PORTS; ++p ) {
+    delete bufs[p];
+  }
+  f->Free();
+
+  return 1.0e9 * (double)( stop - start ) / CLOCKS_PER_SEC /
+    ( (double)cycles * PORTS );
+}
+
+int main( int argc, char **argv )
+{
+  int cycles = ( argc > 1 ) ? atoi(argv[1]) : 200000;
+  int vcs = ( argc > 2 ) ? atoi(argv[2]) : 8;
+
+  vector<string> policies;
+  for ( int i = 3; i < argc; ++i ) {
+    policies.push_back(argv[i]);
+  }
+  if ( policies.empty() ) {
+    string const defaults[] = { "private", "shared", "limited", "dynamic",
+				"shifting", "feedback", "simplefeedback" };
+    policies.assign(defaults, defaults + sizeof(defaults) / sizeof(string));
+  }
+
+  cout << setw(16) << "buffer_policy" << setw(10) << "num_vcs"
+       << setw(12) << "ns/alloc" << setw(22) << "checksum" << endl;
+
+  for ( size_t p = 0; p < policies.size(); ++p ) {
+    unsigned long long sum;
+    double time = run(policies[p], vcs, cycles, sum);
+    cout << setw(16) << policies[p] << setw(10) << vcs
+	 << setw(12) << fixed << setprecision(1) << time
+	 << setw(22) << sum << endl;
+  }
+
+  return 0;
+}
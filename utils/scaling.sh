@@ -0,0 +1,99 @@
+#!/bin/sh
+
+# $Id$
+
+# Copyright (c) 2007-2015, Trustees of The Leland Stanford Junior University
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+#
+# Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+# Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+# IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+# ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+# LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+# CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+# SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+# INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+# ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+
+
+# This is a helper script that measures how the simulator's runtime scales
+# with the number of threads used to evaluate the network.
+#
+# It takes a complete booksim commandline as its parameter.
+#
+# Example:
+#
+#  ./scaling.sh ./booksim configfile
+#
+# The thread counts to try can be set using the 'thread_counts' environment
+# variable (defaults to "1 2 4 8"). The first count serves as the reference:
+# for every other count, the script reports the speedup relative to it and
+# checks that the simulation output is identical. Status information is 
+# printed out in lines that begin with "SCALING: ".
+
+if [ "${1}" = "" ]
+then
+    echo "SCALING: Please specify a simulator executable as the first parameter."
+    exit
+fi
+
+sim=${1}
+shift
+
+if [ "${thread_counts}" = "" ]
+then
+    thread_counts="1 2 4 8"
+fi
+
+ref_threads=""
+ref_time=""
+log=${sim}.${HOSTNAME}.${$}
+
+for threads in ${thread_counts}
+do
+    echo "SCALING: Simulating with ${threads} thread(s)..."
+    ${sim} $* threads=${threads} > ${log}.${threads}.log
+    time=`grep "Total run time" ${log}.${threads}.log | cut -d " " -f 4`
+    if [ "${time}" = "" ]
+    then
+	echo "SCALING: Simulation run failed."
+	tail -n 1 ${log}.${threads}.log
+	rm ${log}.${threads}.log
+	continue
+    fi
+    grep -v "Total run time" ${log}.${threads}.log | grep -v "threads" > ${log}.${threads}.out
+    rm ${log}.${threads}.log
+    if [ "${ref_time}" = "" ]
+    then
+	ref_threads=${threads}
+	ref_time=${time}
+	echo "SCALING: ${threads} thread(s): ${time} s"
+	continue
+    fi
+    speedup="`awk -v t0=${ref_time} -v t1=${time} 'BEGIN{ printf "%.2f", t0 / t1 }'`"
+    if cmp -s ${log}.${ref_threads}.out ${log}.${threads}.out
+    then
+	result="output identical"
+    else
+	result="OUTPUT DIFFERS"
+    fi
+    echo "SCALING: ${threads} thread(s): ${time} s, speedup ${speedup}, ${result}"
+    rm ${log}.${threads}.out
+done
+
+if [ "${ref_threads}" != "" ]
+then
+    rm ${log}.${ref_threads}.out
+fi
+echo "SCALING: Scaling measurement complete."